@@ -50,6 +50,35 @@ function fetchSettings() {
         });
 }
 
+function fetchAirtime() {
+    fetch("/airtime.json")
+        .then((response) => response.json())
+        .then((airtime) => {
+            const airtimeContainer = document.getElementById("lora-airtime");
+            airtimeContainer.innerHTML = "";
+
+            airtime.profiles.forEach((profile, index) => {
+                const row = document.createElement("tr");
+                if (index === airtime.current) row.classList.add("table-active");
+                [
+                    (profile.frequency / 1000000).toFixed(3) + " MHz",
+                    profile.limit.toFixed(1) + " %",
+                    (profile.lastMinute / 1000).toFixed(1) + " s",
+                    (profile.last10Minutes / 1000).toFixed(1) + " s",
+                    (profile.lastHour / 1000).toFixed(1) + " s",
+                    profile.packets,
+                    profile.load + " %",
+                ].forEach((value) => {
+                    const cell = document.createElement("td");
+                    cell.textContent = value;
+                    row.appendChild(cell);
+                });
+                airtimeContainer.appendChild(row);
+            });
+        })
+        .catch((err) => console.error(err));
+}
+
 function loadSettings(settings) {
     currentSettings = settings;
     
@@ -172,6 +201,8 @@ function loadSettings(settings) {
     document.getElementById("nonSmartBeaconRate").value                 = settings.other.nonSmartBeaconRate;
     document.getElementById("rememberStationTime").value                = settings.other.rememberStationTime;
     document.getElementById("standingUpdateTime").value                 = settings.other.standingUpdateTime;
+    document.getElementById("dedupTime").value                          = settings.other.dedupTime;
+    document.getElementById("packetLog").checked                        = settings.other.packetLog;
     document.getElementById("sendAltitude").checked                     = settings.other.sendAltitude ;
     document.getElementById("disableGPS").checked                       = settings.other.disableGPS;
     document.getElementById("email").value                              = settings.other.email;
@@ -488,4 +519,6 @@ form.addEventListener("submit", async (event) => {
 });
 
 
-fetchSettings();
\ No newline at end of file
+fetchSettings();
+fetchAirtime();
+setInterval(fetchAirtime, 10000);
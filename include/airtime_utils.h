@@ -0,0 +1,52 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AIRTIME_UTILS_H_
+#define AIRTIME_UTILS_H_
+
+#include <Arduino.h>
+#include "configuration.h"
+
+#define AIRTIME_MAX_PROFILES    8
+#define AIRTIME_PREAMBLE        8       // symbols, RadioLib default
+#define AIRTIME_DIGIPEAT_LOAD   75      // % of the duty-cycle limit above which digipeating stops
+
+
+struct AirtimeUsage {
+    uint32_t    lastMinute;         // ms on air
+    uint32_t    last10Minutes;
+    uint32_t    lastHour;
+    uint32_t    packets;            // since boot
+    uint16_t    limit;              // duty-cycle limit in permille
+    uint8_t     load;               // % of the limit used, worst of the 10 min and 1 h windows
+};
+
+namespace AIRTIME_Utils {
+
+    uint32_t        getTimeOnAir(const LoraType& loraType, size_t length);
+    uint16_t        getDutyCycleLimit(long frequency);
+    void            recordTransmission(size_t length);
+    AirtimeUsage    getUsage(uint8_t profile);
+    uint8_t         getLoad();
+    uint8_t         getBeaconBackoff();
+    bool            canDigipeat();
+    void            logStats();
+
+}
+
+#endif
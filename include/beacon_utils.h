@@ -0,0 +1,48 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BEACON_UTILS_H_
+#define BEACON_UTILS_H_
+
+#include <Arduino.h>
+
+#define BEACON_MAX_LENGTH       256
+#define BEACON_HEADER_SIZE      96
+
+
+struct BeaconPacket {           // assembled in place, truncated at BEACON_MAX_LENGTH - 1
+    char        data[BEACON_MAX_LENGTH];
+    size_t      length;
+};
+
+namespace BEACON_Utils {
+
+    void        clear(BeaconPacket& packet);
+    void        append(BeaconPacket& packet, const char* text, size_t length);
+    void        vappendf(BeaconPacket& packet, const char* format, va_list args);
+
+    void        startPosition(bool withPath);
+    void        startMicE(bool withPath);
+    void        append(const char* text);
+    void        append(const String& text);
+    void        appendf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+    String      finish();
+
+}
+
+#endif
@@ -20,13 +20,24 @@
 #define BLE_UTILS_H_
 
 #include <Arduino.h>
+#include "lora_utils.h"
 
 
+struct BLETxStats {
+    uint32_t    frames;
+    uint32_t    bytes;
+    uint32_t    throughput;     // bytes/s while sending
+    uint32_t    maxQueueDepth;
+    uint32_t    dropped;
+};
+
 namespace BLE_Utils {
 
     void stop();
     void setup();
     void sendToLoRa();
+    BLETxStats getTxStats();
+    void sendToPhone(const StringView& packet);
     void sendToPhone(const String& packet);
 
 }
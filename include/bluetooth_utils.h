@@ -20,6 +20,7 @@
 #define BLUETOOTH_UTILS_H
 
 #include <BluetoothSerial.h>
+#include "lora_utils.h"
 
 
 namespace BLUETOOTH_Utils {
@@ -28,6 +29,7 @@ namespace BLUETOOTH_Utils {
     void bluetoothCallback(esp_spp_cb_event_t event, esp_spp_cb_param_t *param);
     void getData(const uint8_t *buffer, size_t size);
     void sendToLoRa();
+    void sendToPhone(const StringView& packet);
     void sendToPhone(const String& packet);
 
 }
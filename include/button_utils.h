@@ -27,6 +27,8 @@ namespace BUTTON_Utils {
     void longPress1();
     void doublePress1();
 
+    void prepareForLightSleep();
+    void resumeFromLightSleep();
     void loop();
     void setup();
 
@@ -19,10 +19,25 @@
 #ifndef CONFIGURATION_H_
 #define CONFIGURATION_H_
 
+#include <ArduinoJson.h>
 #include <Arduino.h>
 #include <vector>
 #include <FS.h>
 
+// Sections of tracker_conf.json, as reported by Configuration::changedSections()
+#define CONFIG_WIFI_AP          0x0001
+#define CONFIG_BEACONS          0x0002
+#define CONFIG_DISPLAY          0x0004
+#define CONFIG_BLUETOOTH        0x0008
+#define CONFIG_LORA             0x0010
+#define CONFIG_BATTERY          0x0020
+#define CONFIG_TELEMETRY        0x0040
+#define CONFIG_WINLINK          0x0080
+#define CONFIG_NOTIFICATION     0x0100
+#define CONFIG_PTT              0x0200
+#define CONFIG_OTHER            0x0400
+#define CONFIG_PINS             0x0800  // a GPIO assignment or the flag enabling it
+
 
 class WiFiAP {
 public:
@@ -140,15 +155,25 @@ public:
     int     nonSmartBeaconRate;
     int     rememberStationTime;
     int     standingUpdateTime;
+    int     dedupTime;
     bool    sendAltitude;
     bool    disableGPS;
+    bool    packetLog;
+
+    bool        loadedFromSnapshot;
+    uint32_t    loadTime;   // us spent loading the configuration at boot
 
     void setDefaultValues();
+    void toJson(JsonDocument& data);
+    uint16_t changedSections(Configuration& previous);
     bool writeFile();
     Configuration();
 
 private:
     bool readFile();
+    bool readSnapshot();
+    bool writeSnapshot(uint32_t jsonCRC);
+    template<typename T> void visitSnapshot(T& io);
 };
 
 #endif
\ No newline at end of file
@@ -23,11 +23,14 @@
 
 
 void displaySetup();
+void displayReconfigure();
 void displayToggle(bool toggle);
 
 void displayShow(const String& header, const String& line1, const String& line2, int wait = 0);
 void displayShow(const String& header, const String& line1, const String& line2, const String& line3, const String& line4, const String& line5, int wait = 0);
 
+bool displayOverlayActive();
+
 void startupScreen(uint8_t index, const String& version);
 
 #endif
\ No newline at end of file
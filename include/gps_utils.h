@@ -21,17 +21,45 @@
 
 #include <Arduino.h>
 
+#define EARTH_RADIUS_KM     6372.795f   // same sphere as TinyGPS++
+#define FAST_DISTANCE_LIMIT 50.0f   // km, up to it the equirectangular distance stays within 5 m
+#define DEG_TO_RAD_F        0.017453292f
+
+
+struct GPSIngestStats {
+    uint32_t    passed;         // GGA/RMC handed to TinyGPS++
+    uint32_t    dropped;        // sentences TinyGPS++ would ignore
+    uint32_t    checksumFailed;
+    uint32_t    overflowed;     // ring full, sentence lost
+};
+
+struct PositionContext {                // a position with its latitude terms precomputed
+    float   latitude;
+    float   longitude;
+    float   cosLatitude;
+    float   sinLatitude;
+    bool    valid;
+};
 
 namespace GPS_Utils {
 
     void    setup();
+    void    setPositionContext(PositionContext& position, float latitude, float longitude);
+    void    getFastDistanceCourse(const PositionContext& from, float latitude, float longitude, float& distanceKm, float& course);
+    void    getGreatCircleDistanceCourse(const PositionContext& from, float latitude, float longitude, float& distanceKm, float& course);
+    void    getDistanceCourse(const PositionContext& from, float latitude, float longitude, float& distanceKm, float& course);
+    void    getDistanceCourse(float latitude, float longitude, float& distanceKm, float& course);
+    void    updatePositionContext();
     void    calculateDistanceCourse(const String& callsign, double checkpointLatitude, double checkPointLongitude);
     void    getData();
     void    setDateFromData();
     void    calculateDistanceTraveled();
     void    calculateHeadingDelta(int speed);
     void    checkStartUpFrames();
-    String  getCardinalDirection(float course);
+    float   getBearing(float course);
+    String  getCardinalDirection(float bearing);
+    GPSIngestStats getIngestStats();
+    void    logIngestStats();
 
 }
 
@@ -41,14 +41,49 @@ enum AX25Char {
 #define HAS_BEEN_DIGIPITED_MASK         0b10000000
 #define IS_LAST_ADDRESS_POSITION_MASK   0b1
 
+#define KISS_MAX_FRAME                  330     // command + 10 AX.25 addresses + control/pid + 256 info
+#define KISS_MAX_ENCODED_FRAME          (2 * KISS_MAX_FRAME + 2)    // every byte escaped + FENDs
+#define AX25_MAX_DIGIPEATERS            8
+
+enum KissError {
+    KissErrorFrame      = -1,   // not a valid TNC2 or AX.25 frame
+    KissErrorAddress    = -2,   // callsign longer than 6 chars or SSID out of 0-15
+    KissErrorDigis      = -3,   // more than 8 digipeaters
+    KissErrorBuffer     = -4    // output buffer too small
+};
+
+
+class KissDeframer {    // byte-at-a-time KISS stream parser, no allocation
+public:
+    KissDeframer();
+    void            reset();
+    bool            feed(uint8_t byte);     // true when a whole frame is ready: valid until next feed()
+    bool            isReceiving() const;
+    uint8_t         command() const;
+    const uint8_t*  data() const;           // AX.25 frame, without the command byte
+    size_t          length() const;
+
+private:
+    enum State {
+        WaitFend,
+        InFrame,
+        Escape,
+        Discard
+    };
+
+    uint8_t     buffer[KISS_MAX_FRAME];
+    size_t      bufferLength;
+    size_t      frameLength;
+    State       state;
+};
 
 namespace KISS_Utils {
 
+    bool validateTNC2Frame(const char* tnc2FormattedFrame, size_t length);
     bool validateTNC2Frame(const String& tnc2FormattedFrame);
-    bool validateKISSFrame(const String& kissFormattedFrame);
 
-    String encodeKISS(const String& frame);
-    String decodeKISS(const String& inputFrame, bool& dataFrame);
+    int encodeKISS(const char* tnc2Frame, size_t length, uint8_t* kissFrame, size_t kissFrameSize);    // KISS length or KissError
+    int decodeAX25(const uint8_t* ax25Frame, size_t length, char* tnc2Frame, size_t tnc2FrameSize);    // TNC2 length or KissError
 
 }
 
@@ -21,12 +21,41 @@
 
 #include <Arduino.h>
 
+#define RX_BATCH_SIZE   4   // packets handled per loop() pass
+#define LORA_FRAME_SIZE 256 // 255 bytes max LoRa payload + null terminator
 
-struct ReceivedLoRaPacket {
-    String  text;
-    int     rssi;
-    float   snr;
-    int     freqError;
+struct StringView {         // non-owning view of packet text, e.g. into a LoRaFrame buffer
+    const char  *data;
+    size_t      length;
+};
+
+struct LoRaFrame {
+    char        data[LORA_FRAME_SIZE];
+    uint16_t    length;
+    int         rssi;
+    float       snr;
+    int         freqError;
+
+    bool isAPRS() const {   // "<\xff\x01" header
+        return length > 3 && data[0] == '\x3c' && data[1] == '\xff' && data[2] == '\x01';
+    }
+
+    // Text after the APRS header. Frames without the header are returned whole: they used to be
+    // cut by 3 bytes as well, which only garbled what reached the phone.
+    StringView payload() const {
+        StringView view;
+        view.data   = isAPRS() ? data + 3 : data;
+        view.length = isAPRS() ? length - 3 : length;
+        return view;
+    }
+};
+
+typedef void (*TxDoneCallback)(uint32_t airtime, bool success);    // airtime in ms
+
+struct LoRaRxStats {
+    uint32_t    received;
+    uint32_t    overflowed;
+    uint32_t    crcFailed;
 };
 
 namespace LoRa_Utils {
@@ -34,10 +63,17 @@ namespace LoRa_Utils {
     void setFlag();
     void changeFreq();
     void setup();
-    void sendNewPacket(const String& newPacket);
+    bool startTransmit(const StringView& newPacket, TxDoneCallback callback);
+    void updateTransmit();
+    bool isTransmitting();
+    void sendNewPacket(const StringView& newPacket);
+    bool isChannelFree();
     void wakeRadio();
-    ReceivedLoRaPacket receiveFromSleep();
-    ReceivedLoRaPacket receivePacket();
+    bool receiveFromSleep(LoRaFrame& receivedFrame);
+    bool receivePacket(LoRaFrame& receivedFrame);
+    LoRaRxStats getRxStats();
+    bool prepareForLightSleep();
+    bool resumeFromLightSleep();
     void sleepRadio();
 
 }
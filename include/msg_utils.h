@@ -20,13 +20,18 @@
 #define MSG_UTILS_H_
 
 #include <Arduino.h>
+#include "msgbuffer_utils.h"
 #include "lora_utils.h"
 
+#define MSGSTORE_APRS_CAPACITY  100     // saved APRS messages, oldest dropped first
+#define MSGSTORE_WLNK_CAPACITY  100     // saved Winlink mail lines
 
-struct Packet15SegBuffer {
-    uint32_t    receivedTime;
-    String      station;
-    String      payload;
+
+typedef bool (*SenderHandler)(PayloadKeyword keyword);
+
+struct SenderRoute {
+    const char*     callsign;
+    SenderHandler   handler;    // returns false to fall back to the plain message handling
 };
 
 namespace MSG_Utils {
@@ -38,15 +43,15 @@ namespace MSG_Utils {
     int     getNumWLNKMails();
     void    loadNumMessages();
     void    loadMessagesFromMemory(uint8_t typeOfMessage);
+    String  getSavedMessage(uint8_t typeOfMessage, int index);
     void    ledNotification();
     void    deleteFile(uint8_t typeOfFile);
     void    saveNewMessage(uint8_t typeMessage, const String& station, const String& newMessage);
     void    sendMessage(const String& station, const String& textMessage);
+    void    setup();
     void    addToOutputBuffer(uint8_t typeOfMessage, const String& station, const String& textMessage);
     void    processOutputBuffer();
-    void    clean15SegBuffer();
-    bool    check15SegBuffer(const String& station, const String& textMessage);
-    void    checkReceivedMessage(ReceivedLoRaPacket packetReceived);
+    void    checkReceivedMessage(const LoRaFrame& packetReceived);
 
 }
 
@@ -0,0 +1,126 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MSGBUFFER_UTILS_H_
+#define MSGBUFFER_UTILS_H_
+
+#include <Arduino.h>
+
+#define DUPLICATE_BUFFER_SIZE   32      // recently heard packets remembered for duplicate checks
+#define MSG_POOL_SIZE           16      // outgoing messages queued or waiting for their ack
+#define MSG_TEXT_SIZE           100
+#define MSG_ACK_TRIES           6
+#define MSG_ACK_BUCKETS         16
+#define MSG_WHEEL_SLOTS         128     // retry timer wheel, one slot per tick
+#define MSG_WHEEL_TICK          1000    // ms
+#define PAYLOAD_TRIE_SIZE       48      // nodes for the payload keywords
+
+
+enum MessageState : uint8_t {
+    MSG_STATE_FREE = 0,
+    MSG_STATE_PENDING,          // not sent yet
+    MSG_STATE_WAITING_ACK
+};
+
+struct OutgoingMessage {
+    char            addressee[10];
+    char            text[MSG_TEXT_SIZE + 1];
+    uint16_t        msgNumber;      // 0 = no ack requested
+    uint8_t         tries;
+    MessageState    state;
+    uint32_t        sequence;       // queue order of pending messages
+    uint32_t        dueTime;        // next retry
+    uint8_t         wheelSlot;
+    int8_t          nextInSlot;     // retry wheel list
+    int8_t          nextInBucket;   // ack lookup list
+};
+
+enum PayloadKeyword : uint8_t {
+    KEYWORD_NONE = 0,
+    KEYWORD_ACK,
+    KEYWORD_PING,
+    KEYWORD_WX,
+    KEYWORD_LOGIN_CHALLENGE,
+    KEYWORD_LOG_OFF
+};
+
+struct TrieNode {
+    char            c;
+    int8_t          child;
+    int8_t          sibling;
+    PayloadKeyword  keyword;    // set if a keyword ends here
+};
+
+// Splits a payload left to right without copying it into intermediate Strings.
+struct PayloadTokenizer {
+    const char*     cursor;
+    const char*     end;
+
+    PayloadTokenizer(const String& payload) : cursor(payload.c_str()), end(payload.c_str() + payload.length()) {}
+
+    // Copies up to the delimiter (or the end) and moves past it.
+    void next(char delimiter, char* token, size_t size) {
+        const char* stop = (const char*)memchr(cursor, delimiter, end - cursor);
+        if (stop == nullptr) stop = end;
+        size_t length = min((size_t)(stop - cursor), size - 1);
+        memcpy(token, cursor, length);
+        token[length] = '\0';
+        cursor = (stop == end) ? end : stop + 1;
+    }
+
+    void skip(size_t count) {
+        cursor = min(cursor + count, end);
+    }
+
+    void skipPast(char c) {
+        const char* found = (const char*)memchr(cursor, c, end - cursor);
+        cursor = (found == nullptr) ? end : found + 1;
+    }
+};
+
+
+struct DuplicateEntry {
+    uint32_t    hash;           // of sender + payload, 0 = empty
+    uint32_t    receivedTime;
+};
+
+typedef void (*RetryHandler)(int8_t index, uint32_t now);
+
+#define MSG_POOL_FULL           -1      // addMessage() results
+#define MSG_ALREADY_QUEUED      -2
+
+// Outgoing message pool, retry wheel, ack buckets, duplicate filter and payload keywords. Nothing
+// here touches the radio or the clock: callers pass the time in.
+namespace MSGBUFFER_Utils {
+
+    uint32_t        hashPacket(const char* station, const char* textMessage);
+    void            setup(uint32_t now);
+    int8_t          addMessage(const char* station, const char* textMessage);
+    int8_t          nextPending();
+    void            waitForAck(int8_t index, uint32_t dueTime);
+    void            scheduleRetry(int8_t index, uint32_t dueTime);
+    void            processWheel(uint32_t now, RetryHandler handler);
+    void            expireMessage(int8_t index);
+    bool            processAck(const char* station, uint16_t msgNumber);
+    void            releaseMessages(const char* station);
+    PayloadKeyword  classifyPayload(const char* payload);
+    bool            checkDuplicate(const char* station, const char* textMessage, uint32_t now, uint32_t window);
+
+}
+
+#endif
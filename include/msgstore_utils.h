@@ -0,0 +1,51 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MSGSTORE_UTILS_H_
+#define MSGSTORE_UTILS_H_
+
+#include <Arduino.h>
+#include <FS.h>
+
+#define MSGSTORE_RECORD_SIZE    128     // record header + text, fixed so slot offsets are computed
+#define MSGSTORE_TEXT_SIZE      (MSGSTORE_RECORD_SIZE - 8)
+#define MSGSTORE_MAX_CAPACITY   128
+
+
+struct MessageStore {
+    const char  *path;
+    uint16_t    capacity;       // records kept, the oldest is overwritten when full
+    File        file;
+    uint32_t    firstSeq;       // oldest record
+    uint32_t    nextSeq;
+    uint16_t    count;          // valid records between firstSeq and nextSeq
+    uint8_t     validSlots[MSGSTORE_MAX_CAPACITY / 8];
+};
+
+namespace MSGSTORE_Utils {
+
+    bool    open(MessageStore& store, const char *legacyPath = nullptr);
+    bool    append(MessageStore& store, const String& text);
+    bool    read(MessageStore& store, uint16_t index, String& text);
+    uint16_t readPage(MessageStore& store, uint16_t firstIndex, String *texts, uint16_t pageSize);
+    uint16_t count(const MessageStore& store);
+    void    clear(MessageStore& store);
+
+}
+
+#endif
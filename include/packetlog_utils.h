@@ -0,0 +1,85 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PACKETLOG_UTILS_H_
+#define PACKETLOG_UTILS_H_
+
+#include <Arduino.h>
+#include <FS.h>
+#include "lora_utils.h"
+
+#define PACKETLOG_ENTRIES           64
+#define PACKETLOG_ARENA_SIZE        4096        // frame text of the logged packets
+#define PACKETLOG_PSRAM_ENTRIES     1024
+#define PACKETLOG_PSRAM_ARENA_SIZE  61440
+#define PACKETLOG_FLUSH_INTERVAL    60000       // ms between appends to flash
+#define PACKETLOG_FILE_SIZE         32768       // the full file is kept as .old and a new one started
+#define PACKETLOG_LINE_SIZE         1800        // one exported packet, frame fully escaped
+
+
+enum PacketLogDirection : uint8_t {
+    PACKETLOG_RX = 0,
+    PACKETLOG_TX
+};
+
+enum PacketLogFormat : uint8_t {
+    PACKETLOG_JSON = 0,
+    PACKETLOG_CSV
+};
+
+struct PacketLogEntry {
+    uint32_t            uptime;         // ms
+    uint32_t            epoch;          // 0 if the clock wasn't set yet
+    uint32_t            senderHash;     // FNV-1a of the sender callsign
+    uint16_t            payloadOffset;  // frame text in the arena
+    uint8_t             payloadLength;
+    uint8_t             type;           // APRS packet type
+    PacketLogDirection  direction;
+    int8_t              snr;            // dB * 4
+    int16_t             rssi;
+    int32_t             freqError;
+};
+
+// Export state of one web request: the flash files first, then what is still only in RAM.
+struct PacketLogCursor {
+    PacketLogFormat     format;
+    uint32_t            senderHash;     // 0 = all senders
+    uint8_t             source;
+    File                file;
+    uint32_t            nextSequence;
+    uint32_t            endSequence;
+    uint32_t            written;
+    size_t              lineLength;
+    size_t              linePosition;
+    char                line[PACKETLOG_LINE_SIZE];
+};
+
+namespace PACKETLOG_Utils {
+
+    void        setup();
+    uint32_t    hashCallsign(const char* callsign);
+    void        addReceived(const LoRaFrame& frame, const String& sender, uint8_t type);
+    void        addTransmitted(const char* frame, size_t length);
+    void        flush(bool force = false);
+
+    void        openCursor(PacketLogCursor& cursor, PacketLogFormat format, const String& sender);
+    size_t      readChunk(PacketLogCursor& cursor, uint8_t* buffer, size_t maxLength);
+
+}
+
+#endif
@@ -20,6 +20,7 @@
 #define POWER_UTILS_H_
 
 #include <Arduino.h>
+#include "configuration.h"
 #include "board_pinout.h"
 #if defined(HAS_AXP2101) || defined(HAS_AXP192)
     #include "XPowersLib.h"
@@ -50,6 +51,7 @@ namespace POWER_Utils {
     void deactivateLoRa();
 
     void externalPinSetup();
+    void externalPinRelease(const Configuration& config);
 
     bool begin(TwoWire &port);
     void setup();
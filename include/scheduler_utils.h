@@ -0,0 +1,61 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCHEDULER_UTILS_H_
+#define SCHEDULER_UTILS_H_
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_JOBS  16
+
+#define EVENT_RADIO_RX      (1 << 0)    // radio task queued a received frame
+#define EVENT_GPS_DATA      (1 << 1)    // gpsSerial has bytes waiting
+#define EVENT_KEY           (1 << 2)    // button pressed
+#define EVENT_BLUETOOTH     (1 << 3)    // phone queued a frame for LoRa
+#define EVENT_TX            (1 << 4)    // packet queued for transmission
+
+typedef void (*JobFunction)();
+typedef void (*IdleHook)(uint32_t idleTime);    // may block up to idleTime ms, returns early on events
+
+struct SchedulerJob {
+    const char  *name;
+    JobFunction function;
+    uint32_t    period;         // ms, 0 = only on events
+    uint32_t    lowPowerPeriod; // ms, used instead of period while in low power idle
+    uint32_t    eventMask;
+    uint32_t    nextRun;
+    uint32_t    runs;
+    uint64_t    totalTime;      // us
+    uint32_t    maxTime;        // us
+};
+
+namespace SCHEDULER_Utils {
+
+    void setup();
+    int  addJob(const char *name, JobFunction function, uint32_t period, uint32_t eventMask = 0, uint32_t lowPowerPeriod = 0);
+    void setIdleHook(IdleHook hook);
+    void setLowPower(bool lowPower);
+    void signalEvent(uint32_t event);
+    void signalEventFromISR(uint32_t event);
+    uint32_t waitForEvent(uint32_t timeout);
+    void run();
+    void logStats();
+
+}
+
+#endif
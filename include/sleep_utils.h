@@ -22,12 +22,27 @@
 #include <Arduino.h>
 
 
+struct LightSleepStats {
+    uint32_t    sleeps;
+    uint64_t    sleepTime;      // us
+    uint32_t    radioWakeups;
+    uint32_t    gpsWakeups;
+    uint32_t    buttonWakeups;
+    uint32_t    timerWakeups;
+};
+
 namespace SLEEP_Utils {
 
     void gpsSleep();
     void gpsWakeUp();
     void checkIfGPSShouldSleep();
 
+    void gpsDataReceived();
+    void lightSleepIdle(uint32_t idleTime);
+    LightSleepStats getLightSleepStats();
+    uint8_t getSleepPercentage();
+    void logLightSleepStats();
+
 }
 
 #endif
\ No newline at end of file
@@ -21,15 +21,21 @@
 
 #include <Arduino.h>
 
+#ifndef NEARBY_STATIONS_CAPACITY
+    #define NEARBY_STATIONS_CAPACITY    64      // heard stations kept for the NEAR BY list (max 127)
+#endif
+
 
 namespace STATION_Utils {
 
     void    nearStationInit();
+    uint8_t getNearStationsCount();
     String  getNearStation(uint8_t position);
 
     void    deleteListenedStationsByTime();
     void    checkListenedStationsByTimeAndDelete();
-    void    orderListenedStationsByDistance(const String& callsign, float distance, float course);
+    void    orderListenedStationsByDistance(const String& callsign, float latitude, float longitude, float distance, float course);
+    void    recalculateDistances();
 
     void    checkStandingUpdateTime();
     void    sendBeacon();
@@ -0,0 +1,41 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef STORAGE_UTILS_H_
+#define STORAGE_UTILS_H_
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define STORAGE_PARTITION       "spiffs"    // LittleFS reuses the old SPIFFS data partition
+#define STORAGE_WRITE_DELAY     5000        // ms a setting must stay unchanged before it is written
+#define STORAGE_MAX_PENDING     8
+#define STORAGE_MIGRATE_CHUNK   1024        // bytes copied at a time from SPIFFS to LittleFS
+
+
+namespace STORAGE_Utils {
+
+    bool    mountFileSystem();
+
+    bool    getValue(const char* key, uint8_t& value);
+    void    setValue(const char* key, uint8_t value);
+    void    flush(bool force = false);
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TX_UTILS_H_
+#define TX_UTILS_H_
+
+#include <Arduino.h>
+#include "lora_utils.h"
+
+#define TX_QUEUE_SIZE           8
+#define TX_PACKET_SIZE          252     // 255 bytes LoRa payload minus the "<\xff\x01" header
+#define TX_BACKOFF_MIN          100     // ms, random backoff after a busy channel
+#define TX_BACKOFF_MAX          800     // ms, multiplied by the number of busy attempts
+#define TX_MAX_BACKOFFS         6       // then the packet is sent anyway
+#define TX_DUTY_CYCLE           10      // % of time own packets may be on air, averaged over the budget
+#define TX_BUDGET_MAX           30000   // ms of airtime that can be saved up for bursts
+
+
+enum TxPriority : uint8_t {     // lower value is sent first
+    TX_PRIORITY_ACK,
+    TX_PRIORITY_MESSAGE,
+    TX_PRIORITY_BEACON,
+    TX_PRIORITY_TELEMETRY,
+    TX_PRIORITY_DIGIPEAT
+};
+
+struct TxStats {
+    uint32_t    sent;
+    uint32_t    dropped;
+    uint32_t    channelBusy;
+    uint32_t    rateLimited;
+};
+
+namespace TX_Utils {
+
+    bool    queuePacket(const StringView& packet, TxPriority priority, uint32_t delayTime = 0, bool selfGenerated = true);
+    bool    queuePacket(const String& packet, TxPriority priority, uint32_t delayTime = 0, bool selfGenerated = true);
+    void    process();
+    void    flush();
+    bool    isIdle();
+    TxStats getStats();
+    void    logStats();
+
+}
+
+#endif
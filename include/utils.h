@@ -30,6 +30,7 @@ namespace Utils {
     String  createTimeString(time_t t);
     void    checkStatus();
     void    checkDisplayEcoMode();
+    void    checkHeapStatus();
     String  getSmartBeaconState();
     void    checkFlashlight();
     void    i2cScannerForPeripherals();
@@ -22,7 +22,7 @@
 #include <ESPAsyncWebServer.h>
 #include <ESPmDNS.h>
 #include <Arduino.h>
-#include <SPIFFS.h>
+#include <LittleFS.h>
 #include <WiFi.h>
 
 
@@ -36,6 +36,7 @@ namespace WEB_Utils {
     void handleBootstrapStyle(AsyncWebServerRequest *request);
     void handleBootstrapScript(AsyncWebServerRequest *request);
 
+    bool applyConfiguration();
     void setup();
 
 }
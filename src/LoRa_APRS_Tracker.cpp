@@ -44,6 +44,7 @@ ____________________________________________________________________*/
 #include <logger.h>
 #include <WiFi.h>
 #include "smartbeacon_utils.h"
+#include "airtime_utils.h"
 #include "bluetooth_utils.h"
 #include "keyboard_utils.h"
 #include "joystick_utils.h"
@@ -62,6 +63,10 @@ ____________________________________________________________________*/
 #include "web_utils.h"
 #include "ble_utils.h"
 #include "wx_utils.h"
+#include "scheduler_utils.h"
+#include "packetlog_utils.h"
+#include "storage_utils.h"
+#include "tx_utils.h"
 #include "display.h"
 #include "utils.h"
 #ifdef HAS_TOUCHSCREEN
@@ -123,12 +128,24 @@ logging::Logger                     logger;
 
 extern bool gpsIsActive;
 
+// scheduler jobs, defined after setup()
+void statusJob();
+void inputJob();
+void loraRxJob();
+void messagesJob();
+void bluetoothJob();
+void notificationJob();
+void housekeepingJob();
+void positionJob();
+void statsJob();
+
 void setup() {
     Serial.begin(115200);
 
     #ifndef DEBUG
         logger.setDebugLevel(logging::LoggerLevel::LOGGER_LEVEL_INFO);
     #endif
+    logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Boot", "Config loaded from %s in %lu us", Config.loadedFromSnapshot ? "snapshot" : "JSON", (unsigned long)Config.loadTime);
 
     POWER_Utils::setup();
     displaySetup();
@@ -142,6 +159,8 @@ void setup() {
     WIFI_Utils::checkIfWiFiAP();
 
     MSG_Utils::loadNumMessages();
+    MSG_Utils::setup();
+    PACKETLOG_Utils::setup();
     GPS_Utils::setup();
     currentLoRaType = &Config.loraTypes[loraIndex];
     LoRa_Utils::setup();
@@ -177,14 +196,28 @@ void setup() {
 
     POWER_Utils::lowerCpuFrequency();
     logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Smart Beacon is: %s", Utils::getSmartBeaconState());
+    SCHEDULER_Utils::setup();      // jobs: name, function, period (ms), wake-up events, period in low power idle (ms)
+    SCHEDULER_Utils::addJob("input",        inputJob,           10,     EVENT_KEY,          100);
+    SCHEDULER_Utils::addJob("status",       statusJob,          100,    EVENT_KEY,          1000);
+    SCHEDULER_Utils::addJob("battery",      BATTERY_Utils::monitor, 50, 0,                  1000);
+    SCHEDULER_Utils::addJob("loraRx",       loraRxJob,          100,    EVENT_RADIO_RX,     1000);
+    SCHEDULER_Utils::addJob("messages",     messagesJob,        100,    0,                  1000);
+    SCHEDULER_Utils::addJob("bluetooth",    bluetoothJob,       100,    EVENT_BLUETOOTH,    1000);
+    SCHEDULER_Utils::addJob("notification", notificationJob,    50,     0,                  250);
+    SCHEDULER_Utils::addJob("housekeeping", housekeepingJob,    1000);
+    SCHEDULER_Utils::addJob("position",     positionJob,        100,    EVENT_GPS_DATA,     1000);
+    SCHEDULER_Utils::addJob("tx",           TX_Utils::process,  50,     EVENT_TX,           500);
+    SCHEDULER_Utils::addJob("stats",        statsJob,           15 * 60 * 1000);
+    SCHEDULER_Utils::setIdleHook(SLEEP_Utils::lightSleepIdle);
+
     logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Main", "Setup Done!");
     menuDisplay = 0;
 }
 
-void loop() {
+void statusJob() {
     currentBeacon = &Config.beacons[myBeaconsIndex];
     if (statusUpdate) {
-        if (APRSPacketLib::checkNocall(currentBeacon->callsign)) {
+        if (APRSPacketLib::checkNocall(currentBeacon->callsign) && !displayOverlayActive()) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "Config", "Change your callsigns in WebConfig");
             displayShow("ERROR", "Callsigns = NOCALL!", "---> change it !!!", 2000);
             KEYBOARD_Utils::rightArrow();
@@ -195,10 +228,9 @@ void loop() {
 
     SMARTBEACON_Utils::checkSettings(currentBeacon->smartBeaconSetting);
     SMARTBEACON_Utils::checkState();
+}
 
-    BATTERY_Utils::monitor();
-    Utils::checkDisplayEcoMode();
-
+void inputJob() {
     #ifdef BUTTON_PIN
         BUTTON_Utils::loop();
     #endif
@@ -209,29 +241,57 @@ void loop() {
     #ifdef HAS_TOUCHSCREEN
         TOUCH_Utils::loop();
     #endif
+}
 
-    ReceivedLoRaPacket packet = LoRa_Utils::receivePacket();
+void loraRxJob() {
+    static LoRaFrame packet;
+    uint8_t receivedPackets = 0;
+    while (receivedPackets < RX_BATCH_SIZE && LoRa_Utils::receivePacket(packet)) {
+        receivedPackets++;
+        MSG_Utils::checkReceivedMessage(packet);
+        if (bluetoothActive && bluetoothConnected) {
+            if (Config.bluetooth.useBLE) {
+                BLE_Utils::sendToPhone(packet.payload());
+            } else {
+                #ifdef HAS_BT_CLASSIC
+                    BLUETOOTH_Utils::sendToPhone(packet.payload());
+                #endif
+            }
+        }
+    }
+    if (receivedPackets == RX_BATCH_SIZE) SCHEDULER_Utils::signalEvent(EVENT_RADIO_RX);    // more may be waiting
+}
 
-    MSG_Utils::checkReceivedMessage(packet);
+void messagesJob() {
     MSG_Utils::processOutputBuffer();
-    MSG_Utils::clean15SegBuffer();
+}
 
+void bluetoothJob() {
     if (bluetoothActive && bluetoothConnected) {
         if (Config.bluetooth.useBLE) {
-            BLE_Utils::sendToPhone(packet.text.substring(3));
             BLE_Utils::sendToLoRa();
         } else {
             #ifdef HAS_BT_CLASSIC
-                BLUETOOTH_Utils::sendToPhone(packet.text.substring(3));
                 BLUETOOTH_Utils::sendToLoRa();
             #endif
         }
     }
+}
 
+void notificationJob() {
     MSG_Utils::ledNotification();
     Utils::checkFlashlight();
+}
+
+void housekeepingJob() {
+    Utils::checkDisplayEcoMode();
+    Utils::checkHeapStatus();
     STATION_Utils::checkListenedStationsByTimeAndDelete();
+    STORAGE_Utils::flush();
+    PACKETLOG_Utils::flush();
+}
 
+void positionJob() {
     lastTx = millis() - lastTxTime;
     if (gpsIsActive) {
         GPS_Utils::getData();
@@ -241,7 +301,10 @@ void loop() {
 
         int currentSpeed = (int) gps.speed.kmph();
 
-        if (gps_loc_update) Utils::checkStatus();
+        if (gps_loc_update) {
+            GPS_Utils::updatePositionContext();
+            Utils::checkStatus();
+        }
 
         if (!sendUpdate && gps_loc_update && smartBeaconActive) {
             GPS_Utils::calculateDistanceTraveled();
@@ -268,4 +331,16 @@ void loop() {
             refreshDisplayTime = millis();
         }
     }
-}
\ No newline at end of file
+}
+
+void statsJob() {
+    SCHEDULER_Utils::logStats();
+    SLEEP_Utils::logLightSleepStats();
+    GPS_Utils::logIngestStats();
+    TX_Utils::logStats();
+    AIRTIME_Utils::logStats();
+}
+
+void loop() {
+    SCHEDULER_Utils::run();
+}
@@ -0,0 +1,135 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "airtime_utils.h"
+#include "tx_utils.h"
+#include "logger.h"
+
+extern Configuration    Config;
+extern logging::Logger  logger;
+extern uint8_t          loraIndex;
+
+#define SHORT_BUCKETS       6       // 10 s buckets -> 1 min window
+#define SHORT_BUCKET_TIME   10000
+#define LONG_BUCKETS        60      // 1 min buckets -> 10 min and 1 h windows
+#define LONG_BUCKET_TIME    60000
+
+
+struct AirtimeCounters {
+    uint32_t    shortBuckets[SHORT_BUCKETS];
+    uint32_t    longBuckets[LONG_BUCKETS];
+    uint32_t    shortEpoch;     // bucket number (millis / bucket time) of the newest bucket
+    uint32_t    longEpoch;
+    uint32_t    packets;
+};
+
+AirtimeCounters airtimeCounters[AIRTIME_MAX_PROFILES];
+
+
+namespace AIRTIME_Utils {
+
+    // Semtech LoRa time on air (SX1276 datasheet 4.1.1.7): explicit header, CRC on, low data
+    // rate optimisation as RadioLib enables it (symbol time of 16 ms or more).
+    uint32_t getTimeOnAir(const LoraType& loraType, size_t length) {
+        int spreadingFactor     = loraType.spreadingFactor;
+        float symbolTime        = (float)(1UL << spreadingFactor) * 1000.0f / loraType.signalBandwidth;  // ms
+        int lowDataRate         = (symbolTime >= 16.0f) ? 1 : 0;
+        int numerator           = 8 * (int)length - 4 * spreadingFactor + 28 + 16;
+        int denominator         = 4 * (spreadingFactor - 2 * lowDataRate);
+        int payloadSymbols      = 8 + max((numerator + denominator - 1) / denominator, 0) * loraType.codingRate4;
+        float preambleTime      = (AIRTIME_PREAMBLE + 4.25f) * symbolTime;
+        return (uint32_t)(preambleTime + payloadSymbols * symbolTime + 0.5f);
+    }
+
+    uint16_t getDutyCycleLimit(long frequency) {    // permille
+        if (frequency >= 863000000 && frequency <= 870000000) return 10;    // EU 868 MHz SRD: 1 %
+        if (frequency >= 433050000 && frequency <= 434790000) return 100;   // EU 433 MHz SRD: 10 %
+        return TX_DUTY_CYCLE * 10;      // no legal limit: keep to the TX queue share
+    }
+
+    // Buckets that fell out of the window since the last call are cleared before use.
+    void advance(uint32_t* buckets, uint8_t size, uint32_t& epoch, uint32_t now) {
+        if (now - epoch >= size) {
+            memset(buckets, 0, size * sizeof(uint32_t));
+        } else {
+            for (uint32_t bucket = epoch + 1; bucket <= now; bucket++) buckets[bucket % size] = 0;
+        }
+        epoch = now;
+    }
+
+    void advanceCounters(AirtimeCounters& counters) {
+        uint32_t now = millis();
+        advance(counters.shortBuckets, SHORT_BUCKETS, counters.shortEpoch, now / SHORT_BUCKET_TIME);
+        advance(counters.longBuckets, LONG_BUCKETS, counters.longEpoch, now / LONG_BUCKET_TIME);
+    }
+
+    void recordTransmission(size_t length) {
+        if (loraIndex >= AIRTIME_MAX_PROFILES || loraIndex >= Config.loraTypes.size()) return;
+        AirtimeCounters& counters = airtimeCounters[loraIndex];
+        advanceCounters(counters);
+        uint32_t airtime = getTimeOnAir(Config.loraTypes[loraIndex], length);
+        counters.shortBuckets[counters.shortEpoch % SHORT_BUCKETS] += airtime;
+        counters.longBuckets[counters.longEpoch % LONG_BUCKETS] += airtime;
+        counters.packets++;
+    }
+
+    AirtimeUsage getUsage(uint8_t profile) {
+        AirtimeUsage usage = {0, 0, 0, 0, 0, 0};
+        if (profile >= AIRTIME_MAX_PROFILES || profile >= Config.loraTypes.size()) return usage;
+        AirtimeCounters& counters = airtimeCounters[profile];
+        advanceCounters(counters);
+
+        for (int i = 0; i < SHORT_BUCKETS; i++) usage.lastMinute += counters.shortBuckets[i];
+        for (int age = 0; age < LONG_BUCKETS; age++) {      // age 0 = current minute
+            uint32_t airtime = counters.longBuckets[(counters.longEpoch + LONG_BUCKETS - age) % LONG_BUCKETS];
+            usage.lastHour += airtime;
+            if (age < 10) usage.last10Minutes += airtime;
+        }
+        usage.packets   = counters.packets;
+        usage.limit     = getDutyCycleLimit(Config.loraTypes[profile].frequency);
+
+        uint32_t hourLoad   = (uint64_t)usage.lastHour * 100000 / (3600000UL * usage.limit);
+        uint32_t tenLoad    = (uint64_t)usage.last10Minutes * 100000 / (600000UL * usage.limit);
+        usage.load          = min(max(hourLoad, tenLoad), (uint32_t)255);
+        return usage;
+    }
+
+    uint8_t getLoad() {
+        return getUsage(loraIndex).load;
+    }
+
+    uint8_t getBeaconBackoff() {    // factor applied to the beacon interval
+        uint8_t load = getLoad();
+        if (load < 50) return 1;
+        if (load < 75) return 2;
+        if (load < 90) return 4;
+        return 8;
+    }
+
+    bool canDigipeat() {
+        return getLoad() < AIRTIME_DIGIPEAT_LOAD;
+    }
+
+    void logStats() {
+        AirtimeUsage usage = getUsage(loraIndex);
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Airtime", "1 min: %u ms 10 min: %u ms 1 h: %u ms load: %u%% of %u.%u%%",
+                    (unsigned int)usage.lastMinute, (unsigned int)usage.last10Minutes, (unsigned int)usage.lastHour, (unsigned int)usage.load,
+                    (unsigned int)(usage.limit / 10), (unsigned int)(usage.limit % 10));
+    }
+
+}
@@ -0,0 +1,122 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <APRSPacketLib.h>
+#include <TinyGPS++.h>
+#include "configuration.h"
+#include "beacon_utils.h"
+#include "logger.h"
+
+extern Configuration        Config;
+extern Beacon               *currentBeacon;
+extern logging::Logger      logger;
+extern TinyGPSPlus          gps;
+extern bool                 sendStandingUpdate;
+
+
+// "CALL>APLRT1[,PATH]:!<overlay>" rendered once, [0] without path and [1] with Config.path
+struct BeaconTemplate {
+    String      callsign;       // what the header was rendered from
+    String      overlay;
+    String      path;
+    bool        valid;
+    char        header[2][BEACON_HEADER_SIZE];
+    size_t      headerLength[2];
+};
+
+BeaconTemplate      beaconTemplate;
+bool                beaconTemplateBuilt = false;
+
+BeaconPacket        beaconPacket;
+
+
+namespace BEACON_Utils {
+
+    // The header is taken from APRSPacketLib itself (called with empty position data) and is only
+    // used if the library output really is header + position, so both paths send identical packets.
+    void buildTemplate() {
+        beaconTemplate.callsign     = currentBeacon->callsign;
+        beaconTemplate.overlay      = currentBeacon->overlay;
+        beaconTemplate.path         = Config.path;
+        beaconTemplate.valid        = true;
+        beaconTemplateBuilt         = true;
+
+        String sample = APRSPacketLib::encodeGPSIntoBase91(0.0, 0.0, 0.0, 0.0, currentBeacon->symbol, false, 0, false);
+        for (int i = 0; i < 2; i++) {
+            String path     = (i == 1) ? Config.path : "";
+            String header   = APRSPacketLib::generateBase91GPSBeaconPacket(currentBeacon->callsign, "APLRT1", path, currentBeacon->overlay, "");
+            String packet   = APRSPacketLib::generateBase91GPSBeaconPacket(currentBeacon->callsign, "APLRT1", path, currentBeacon->overlay, sample);
+            if (header.length() >= BEACON_HEADER_SIZE || packet != header + sample) {
+                beaconTemplate.valid = false;
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Beacon", "Header can't be precompiled, building full packets");
+                return;
+            }
+            memcpy(beaconTemplate.header[i], header.c_str(), header.length() + 1);
+            beaconTemplate.headerLength[i] = header.length();
+        }
+    }
+
+    // Keyed on what the header is made of, so a profile switch or a path change from the web
+    // config rebuilds it, while profiles sharing callsign, overlay and path share it.
+    bool templateMatches() {
+        return  beaconTemplateBuilt &&
+                beaconTemplate.callsign == currentBeacon->callsign &&
+                beaconTemplate.overlay == currentBeacon->overlay &&
+                beaconTemplate.path == Config.path;
+    }
+
+    void append(const char* text) {
+        append(beaconPacket, text, strlen(text));
+    }
+
+    void append(const String& text) {
+        append(beaconPacket, text.c_str(), text.length());
+    }
+
+    void appendf(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        vappendf(beaconPacket, format, args);
+        va_end(args);
+    }
+
+    // Only the compressed position (with course/speed or altitude) is encoded per TX.
+    void startPosition(bool withPath) {
+        clear(beaconPacket);
+        if (!templateMatches()) buildTemplate();
+
+        String position = APRSPacketLib::encodeGPSIntoBase91(gps.location.lat(),gps.location.lng(), gps.course.deg(), gps.speed.knots(), currentBeacon->symbol, Config.sendAltitude, gps.altitude.feet(), sendStandingUpdate);
+        if (beaconTemplate.valid) {
+            append(beaconPacket, beaconTemplate.header[withPath], beaconTemplate.headerLength[withPath]);
+            append(position);
+        } else {
+            append(APRSPacketLib::generateBase91GPSBeaconPacket(currentBeacon->callsign, "APLRT1", withPath ? Config.path : String(), currentBeacon->overlay, position));
+        }
+    }
+
+    // Mic-E spreads the position over the destination field, so there is no fixed header to keep.
+    void startMicE(bool withPath) {
+        clear(beaconPacket);
+        append(APRSPacketLib::generateMiceGPSBeaconPacket(currentBeacon->micE, currentBeacon->callsign, currentBeacon->symbol, currentBeacon->overlay, withPath ? Config.path : String(), gps.location.lat(), gps.location.lng(), gps.course.deg(), gps.speed.knots(), gps.altitude.meters()));
+    }
+
+    String finish() {
+        return String(beaconPacket.data);
+    }
+
+}
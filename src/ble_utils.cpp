@@ -19,13 +19,17 @@
 #include <NimBLEDevice.h>
 #include "configuration.h"
 #include "lora_utils.h"
+#include "tx_utils.h"
+#include "scheduler_utils.h"
 #include "kiss_utils.h"
 #include "ble_utils.h"
 #include "display.h"
 #include "logger.h"
 
-#define BLE_CHUNK_SIZE  512
-#define MAX_KISS_BUFFER 1024
+#define TO_LORA_QUEUE_SIZE  4
+#define TO_PHONE_QUEUE_SIZE 8
+#define BLE_TX_RETRIES      50      // x 10ms waiting for the stack to free notify buffers
+#define BLE_STOP_TIMEOUT    1000    // ms for the Tx task to finish its frame and exit
 
 
 // APPLE - APRS.fi app
@@ -47,95 +51,204 @@ extern logging::Logger  logger;
 extern bool             bluetoothConnected;
 extern bool             bluetoothActive;
 
-bool    shouldSendBLEtoLoRa     = false;
-String  BLEToLoRaPacket         = "";
-String  kissSerialBuffer        = "";
+QueueHandle_t   bleToLoRaQueue  = NULL;
+QueueHandle_t   bleToPhoneQueue = NULL;
+KissDeframer    bleKissDeframer;
+
+TaskHandle_t        bleTxTaskHandle = NULL;
+SemaphoreHandle_t   bleTxTaskDone   = NULL;     // given by the Tx task right before it deletes itself
+
+uint8_t         bleTxBuffer[KISS_MAX_ENCODED_FRAME];        // reused for every frame sent to the phone
+uint16_t        bleMTU          = BLE_ATT_MTU_DFLT;
+bool            bleTxEnabled    = false;
+volatile int    bleNotifyState  = 0;
+BLETxStats      bleTxStats      = {0, 0, 0, 0, 0};
+uint32_t        bleTxTime       = 0;                        // ms spent sending, for throughput
+
+
+static void queueToLoRa(const char* text, size_t length) {  // runs on the NimBLE host task
+    if (bleToLoRaQueue == NULL || length == 0) return;
+    LoRaFrame frame;
+    if (length > LORA_FRAME_SIZE - 4) length = LORA_FRAME_SIZE - 4;   // room for the LoRa APRS header
+    memcpy(frame.data, text, length);
+    frame.data[length]  = '\0';
+    frame.length        = length;
+    frame.rssi          = 0;
+    frame.snr           = 0;
+    frame.freqError     = 0;
+    if (xQueueSend(bleToLoRaQueue, &frame, 0) != pdTRUE) {
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "BLE", "%s", "Tx queue full, frame dropped");
+    }
+    SCHEDULER_Utils::signalEvent(EVENT_BLUETOOTH);
+}
 
 
 class MyServerCallbacks : public NimBLEServerCallbacks {
     void onConnect(NimBLEServer* pServer) {
         bluetoothConnected = true;
+        bleKissDeframer.reset();
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "BLE", "%s", "BLE Client Connected");
         delay(100);
     }
 
     void onDisconnect(NimBLEServer* pServer) {
-        bluetoothConnected = false;
+        bluetoothConnected  = false;
+        bleMTU              = BLE_ATT_MTU_DFLT;
+        BLETxStats stats    = BLE_Utils::getTxStats();
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "BLE", "Tx: %u frames %u bytes %u B/s, max queue %u, dropped %u",
+            (unsigned int)stats.frames, (unsigned int)stats.bytes, (unsigned int)stats.throughput, (unsigned int)stats.maxQueueDepth, (unsigned int)stats.dropped);
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "BLE", "%s", "BLE client Disconnected, Started Advertising");
         delay(100);
         pServer->startAdvertising();
     }
+
+    void onMTUChange(uint16_t MTU, ble_gap_conn_desc* desc) {
+        bleMTU = MTU;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BLE", "MTU: %d", MTU);
+    }
+};
+
+class MyTxCallbacks : public NimBLECharacteristicCallbacks {
+    void onStatus(NimBLECharacteristic* pCharacteristic, Status s, int code) {
+        bleNotifyState = code;      // called from notify(): 0 or the NimBLE error (BLE_HS_ENOMEM when congested)
+    }
 };
 
 class MyCallbacks : public NimBLECharacteristicCallbacks {
     void onWrite(NimBLECharacteristic *pCharacteristic) {
+        std::string receivedData = pCharacteristic->getValue();
         if (Config.bluetooth.useKISS) {   // KISS (AX.25)
-            std::string receivedData = pCharacteristic->getValue();
-
-            for (uint8_t c : receivedData) {                                                // save all received data from buffer
-                kissSerialBuffer += (char)c;
+            for (uint8_t c : receivedData) {            // frames may be split across writes or packed in one
+                if (bleKissDeframer.feed(c) && bleKissDeframer.command() == KissCmd::Data) {
+                    char tnc2Frame[LORA_FRAME_SIZE];
+                    int tnc2Length = KISS_Utils::decodeAX25(bleKissDeframer.data(), bleKissDeframer.length(), tnc2Frame, sizeof(tnc2Frame));
+                    if (tnc2Length > 0) queueToLoRa(tnc2Frame, tnc2Length);
+                }
             }
-            if (kissSerialBuffer.length() > MAX_KISS_BUFFER) {                              // buffer overflow protection
-                kissSerialBuffer = "";
+        } else {                            // TNC2
+            queueToLoRa(receivedData.c_str(), receivedData.length());
+        }
+    }
+};
+
+namespace BLE_Utils {
+
+    void sendToLoRa() {
+        static LoRaFrame frame;
+        if (bleToLoRaQueue == NULL || xQueueReceive(bleToLoRaQueue, &frame, 0) != pdTRUE) return;
+
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BLE Tx", "%s", frame.data);
+        displayShow("BLE Tx >>", "", frame.data, 1000);
+        StringView packet = {frame.data, frame.length};
+        TX_Utils::queuePacket(packet, TX_PRIORITY_MESSAGE);
+    }
+
+    bool notifyChunk(const uint8_t* chunk, size_t chunkSize) {
+        for (int retry = 0; retry < BLE_TX_RETRIES; retry++) {
+            if (!bleTxEnabled || !bluetoothConnected) return false;
+            bleNotifyState = 0;
+            pCharacteristicTx->setValue(chunk, chunkSize);
+            pCharacteristicTx->notify();
+            if (bleNotifyState == 0) return true;
+            vTaskDelay(pdMS_TO_TICKS(10));                  // out of notify buffers: wait for the link to drain
+        }
+        return false;
+    }
+
+    void txToPhoneOverBLE(const LoRaFrame& frame) {
+        int length;
+        if (Config.bluetooth.useKISS) {   // KISS (AX.25)
+            length = KISS_Utils::encodeKISS(frame.data, frame.length, bleTxBuffer, sizeof(bleTxBuffer));
+            if (length < 0) {
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "BLE", "KISS encode failed: %d", length);
                 return;
             }
+        } else {        // TNC2
+            length = frame.length;
+            memcpy(bleTxBuffer, frame.data, length);
+            bleTxBuffer[length++] = '\n';
+        }
 
-            int maxIterations = 10;                                                        // infinite loop protection
-            while (maxIterations-- > 0) {
-
-                if (kissSerialBuffer.length() == 0) break;                                  // empty buffer protection
-
-                int fendIndex = -1;
-                if (kissSerialBuffer.charAt(0) == (char)KissChar::FEND) {                   // starts with FEND???
-                    for (int i = 1; i < kissSerialBuffer.length(); i++) {                   // look for next FEND
-                        if (kissSerialBuffer.charAt(i) == (char)KissChar::FEND) {
-                            fendIndex = i;
-                            break;
-                        }
-                    }
-                } else {
-                    int firstFendIndex = kissSerialBuffer.indexOf((char)KissChar::FEND);    // find first FEND byte to discard leading corrupted bytes
-                    if (firstFendIndex != -1) {
-                        kissSerialBuffer.remove(0, firstFendIndex);                         // delete corrupted data before FEND
-                    } else {
-                        kissSerialBuffer = "";                                              // if no FEND found, delete all
-                        break;
-                    }
-                    continue;
-                }
+        uint32_t startTime  = millis();
+        int maxChunkSize    = bleMTU - 3;                       // ATT notification header
+        for (int i = 0; i < length; i += maxChunkSize) {
+            int chunkSize = (length - i < maxChunkSize) ? (length - i) : maxChunkSize;
+            if (!notifyChunk(bleTxBuffer + i, chunkSize)) {
+                bleTxStats.dropped++;
+                return;
+            }
+            bleTxStats.bytes += chunkSize;
+        }
+        bleTxStats.frames++;
+        bleTxTime += millis() - startTime;
+    }
 
-                if (fendIndex == -1) {                                                      // exit: no FEND byte to process the kissSerialBuffer (yet)
-                    break;
-                }
+    void txTask(void *parameter) {
+        static LoRaFrame frame;
+        for (;;) {
+            if (xQueueReceive(bleToPhoneQueue, &frame, portMAX_DELAY) == pdTRUE) {
+                if (frame.length == 0 && !bleTxEnabled) break;      // stop(): never queued by sendToPhone()
+                if (bleTxEnabled && bluetoothConnected) txToPhoneOverBLE(frame);
+            }
+        }
+        xSemaphoreGive(bleTxTaskDone);
+        vTaskDelete(NULL);
+    }
 
-                String frame = kissSerialBuffer.substring(0, fendIndex + 1);                // extract full frame (With FEND at start and end)
-                kissSerialBuffer.remove(0, fendIndex + 1);
+    BLETxStats getTxStats() {
+        bleTxStats.throughput = (bleTxTime > 0) ? (bleTxStats.bytes * 1000 / bleTxTime) : 0;
+        return bleTxStats;
+    }
 
-                if (frame.length() >= 4) {                                                  // FEND | CMD | DATA | FEND
-                    bool isDataFrame    = false;
-                    BLEToLoRaPacket     = KISS_Utils::decodeKISS(frame, isDataFrame);
-                    if (isDataFrame) shouldSendBLEtoLoRa = true;
-                }
+    void sendToPhone(const StringView& packet) {
+        if (packet.length > 0 && bluetoothConnected && bleToPhoneQueue != NULL) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BLE Rx", "%.*s", (int)packet.length, packet.data);
+            static LoRaFrame frame;
+            size_t length = (packet.length < LORA_FRAME_SIZE - 1) ? packet.length : LORA_FRAME_SIZE - 1;
+            memcpy(frame.data, packet.data, length);
+            frame.data[length]  = '\0';
+            frame.length        = length;
+            if (xQueueSend(bleToPhoneQueue, &frame, 0) != pdTRUE) {
+                bleTxStats.dropped++;
+                return;
             }
-        } else {                            // TNC2
-            std::string receivedData = pCharacteristic->getValue();
-            String receivedString = "";
-            for (int i = 0; i < receivedData.length(); i++) receivedString += receivedData[i];
-            BLEToLoRaPacket = receivedString;
-            shouldSendBLEtoLoRa = true;
+            uint32_t queueDepth = uxQueueMessagesWaiting(bleToPhoneQueue);
+            if (queueDepth > bleTxStats.maxQueueDepth) bleTxStats.maxQueueDepth = queueDepth;
         }
     }
-};
 
-namespace BLE_Utils {
+    void sendToPhone(const String& packet) {
+        StringView packetView = {packet.c_str(), packet.length()};
+        sendToPhone(packetView);
+    }
 
+    // The Tx task may be inside notify(): it is told to exit and waited for, so the stack is
+    // never torn down under it.
     void stop() {
+        bleTxEnabled = false;
+        if (bleTxTaskHandle != NULL) {
+            static LoRaFrame stopFrame;
+            stopFrame.length = 0;
+            xQueueReset(bleToPhoneQueue);
+            xQueueSend(bleToPhoneQueue, &stopFrame, 0);
+            if (xSemaphoreTake(bleTxTaskDone, pdMS_TO_TICKS(BLE_STOP_TIMEOUT)) != pdTRUE) {
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "BLE", "%s", "Tx task did not stop, BLE left running");
+                return;
+            }
+            bleTxTaskHandle = NULL;
+        }
         BLEDevice::deinit();
     }
 
     void setup() {
         String BLEid = Config.bluetooth.deviceName;
         BLEDevice::init(BLEid.c_str());
+        BLEDevice::setMTU(BLE_ATT_MTU_MAX);
+        if (bleToLoRaQueue == NULL) bleToLoRaQueue = xQueueCreate(TO_LORA_QUEUE_SIZE, sizeof(LoRaFrame));
+        if (bleToPhoneQueue == NULL) bleToPhoneQueue = xQueueCreate(TO_PHONE_QUEUE_SIZE, sizeof(LoRaFrame));
+        if (bleTxTaskDone == NULL) bleTxTaskDone = xSemaphoreCreateBinary();
+        xQueueReset(bleToLoRaQueue);
+        xQueueReset(bleToPhoneQueue);
         pServer = BLEDevice::createServer();
         pServer->setCallbacks(new MyServerCallbacks());
 
@@ -149,7 +262,10 @@ namespace BLE_Utils {
 
         if (pService != nullptr) {
             pCharacteristicRx->setCallbacks(new MyCallbacks());
+            pCharacteristicTx->setCallbacks(new MyTxCallbacks());
             pService->start();
+            bleTxEnabled = true;
+            if (bleTxTaskHandle == NULL) xTaskCreate(txTask, "bleTxTask", 4096, NULL, 1, &bleTxTaskHandle);
 
             BLEAdvertising* pAdvertising = BLEDevice::getAdvertising();
             pAdvertising->addServiceUUID(useKISS ? SERVICE_UUID_0 : SERVICE_UUID_1);
@@ -164,52 +280,4 @@ namespace BLE_Utils {
         }
     }
 
-    void sendToLoRa() {
-        if (!shouldSendBLEtoLoRa) return;
-
-        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BLE Tx", "%s", BLEToLoRaPacket.c_str());
-        displayShow("BLE Tx >>", "", BLEToLoRaPacket, 1000);
-        LoRa_Utils::sendNewPacket(BLEToLoRaPacket);
-        BLEToLoRaPacket = "";
-        shouldSendBLEtoLoRa = false;
-    }
-
-    void txBLE(uint8_t p) {
-        pCharacteristicTx->setValue(&p,1);
-        pCharacteristicTx->notify();
-        delay(3);
-    }
-
-    void txToPhoneOverBLE(const String& frame) {
-        if (Config.bluetooth.useKISS) {   // KISS (AX.25)
-            const String kissEncodedFrame = KISS_Utils::encodeKISS(frame);
-
-            const char* t   = kissEncodedFrame.c_str();
-            int length      = kissEncodedFrame.length();
-            for (int i = 0; i < length; i += BLE_CHUNK_SIZE) {
-                int chunkSize = (length - i < BLE_CHUNK_SIZE) ? (length - i) : BLE_CHUNK_SIZE;
-
-                uint8_t* chunk = new uint8_t[chunkSize];
-                memcpy(chunk, t + i, chunkSize);
-
-                pCharacteristicTx->setValue(chunk, chunkSize);
-                pCharacteristicTx->notify();
-                delete[] chunk;
-                delay(200);
-            }
-        } else {        // TNC2
-            for (int n = 0; n < frame.length(); n++) txBLE(frame[n]);
-            txBLE('\n');
-        }
-    }
-
-    void sendToPhone(const String& packet) {
-        if (!packet.isEmpty() && bluetoothConnected) {
-            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BLE Rx", "%s", packet.c_str());
-            String receivedPacketString = "";
-            for (int i = 0; i < packet.length(); i++) receivedPacketString += packet[i];
-            txToPhoneOverBLE(receivedPacketString);
-        }
-    }
-
 }
\ No newline at end of file
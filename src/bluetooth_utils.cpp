@@ -21,10 +21,14 @@
 #include "bluetooth_utils.h"
 #include "configuration.h"
 #include "lora_utils.h"
+#include "tx_utils.h"
+#include "scheduler_utils.h"
 #include "kiss_utils.h"
 #include "display.h"
 #include "logger.h"
 
+#define TO_LORA_QUEUE_SIZE  4
+
 
 extern Configuration    Config;
 extern BluetoothSerial  SerialBT;
@@ -34,8 +38,8 @@ extern bool             bluetoothConnected;
 extern bool             bluetoothActive;
 
 namespace BLUETOOTH_Utils {
-    String serialReceived;
-    bool shouldSendToLoRa = false;
+    QueueHandle_t   btToLoRaQueue   = NULL;
+    KissDeframer    btKissDeframer;
     bool useKiss = Config.bluetooth.useKISS? true : false;
 
     void setup() {
@@ -46,7 +50,7 @@ namespace BLUETOOTH_Utils {
             return;
         }
 
-        serialReceived.reserve(255);
+        btToLoRaQueue = xQueueCreate(TO_LORA_QUEUE_SIZE, sizeof(LoRaFrame));
 
         SerialBT.register_callback(BLUETOOTH_Utils::bluetoothCallback);
         SerialBT.onData(BLUETOOTH_Utils::getData); // callback instead of while to avoid RX buffer limit when NMEA data received
@@ -66,6 +70,7 @@ namespace BLUETOOTH_Utils {
     void bluetoothCallback(esp_spp_cb_event_t event, esp_spp_cb_param_t *param) {
         if (event == ESP_SPP_SRV_OPEN_EVT) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Bluetooth", "Client connected !");
+            btKissDeframer.reset();
             bluetoothConnected = true;
         } else if (event == ESP_SPP_CLOSE_EVT) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Bluetooth", "Client disconnected !");
@@ -75,62 +80,79 @@ namespace BLUETOOTH_Utils {
         }
     }
 
+    void queueToLoRa(const char* text, size_t length) {     // runs on the BT task
+        if (btToLoRaQueue == NULL || length == 0) return;
+        if (!KISS_Utils::validateTNC2Frame(text, length)) return;
+        LoRaFrame frame;
+        if (length > LORA_FRAME_SIZE - 4) length = LORA_FRAME_SIZE - 4;   // room for the LoRa APRS header
+        memcpy(frame.data, text, length);
+        frame.data[length]  = '\0';
+        frame.length        = length;
+        frame.rssi          = 0;
+        frame.snr           = 0;
+        frame.freqError     = 0;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "Data received should be transmitted to RF => %s", frame.data);
+        if (xQueueSend(btToLoRaQueue, &frame, 0) != pdTRUE) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "bluetooth", "%s", "Tx queue full, frame dropped");
+        }
+        SCHEDULER_Utils::signalEvent(EVENT_BLUETOOTH);
+    }
+
     void getData(const uint8_t *buffer, size_t size) {
         if (size == 0) return;
-        shouldSendToLoRa = false;
-        serialReceived.clear();
         bool isNmea = buffer[0] == '$';
-        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "Received buffer size %d. Nmea=%d. %s", size, isNmea, buffer);
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "Received buffer size %d. Nmea=%d", size, isNmea);
 
-        for (int i = 0; i < size; i++) {
-            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "[%d/%d] %x -> %c", i + 1, size, buffer[i], buffer[i]);
-        }
-        for (int i = 0; i < size; i++) {
-            char c = (char) buffer[i];
-            if (isNmea) {
-                gps.encode(c);
-            } else {
-                serialReceived += c;
-            }
-        }
-        // Test if we have to send frame
-        isNmea = serialReceived.indexOf("$G") != -1 || serialReceived.indexOf("$B") != -1;
-        if (isNmea) useKiss = false;
-        if (isNmea || serialReceived.isEmpty()) return;
-        if (KISS_Utils::validateKISSFrame(serialReceived)) {
-            bool dataFrame;
-            String decodeKiss = KISS_Utils::decodeKISS(serialReceived, dataFrame);
-            serialReceived.clear();
-            serialReceived += decodeKiss;
-            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "It's a kiss frame. dataFrame: %d", dataFrame);
+        if (isNmea) {
+            useKiss = false;
+            for (int i = 0; i < size; i++) gps.encode((char)buffer[i]);
+        } else if (buffer[0] == KissChar::FEND || btKissDeframer.isReceiving()) {
             useKiss = true;
+            for (int i = 0; i < size; i++) {       // frames may be split across callbacks or packed in one
+                if (btKissDeframer.feed(buffer[i])) {
+                    bool dataFrame = btKissDeframer.command() == KissCmd::Data;
+                    logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "It's a kiss frame. dataFrame: %d", dataFrame);
+                    if (dataFrame) {
+                        char tnc2Frame[LORA_FRAME_SIZE];
+                        int tnc2Length = KISS_Utils::decodeAX25(btKissDeframer.data(), btKissDeframer.length(), tnc2Frame, sizeof(tnc2Frame));
+                        if (tnc2Length > 0) queueToLoRa(tnc2Frame, tnc2Length);
+                    }
+                }
+            }
         } else {
             useKiss = false;
-        }
-        if (KISS_Utils::validateTNC2Frame(serialReceived)) {
-            shouldSendToLoRa = true;
-            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "bluetooth", "Data received should be transmitted to RF => %s", serialReceived.c_str());
+            while (size > 0 && (buffer[size - 1] == '\n' || buffer[size - 1] == '\r')) size--;
+            queueToLoRa((const char*)buffer, size);
         }
     }
 
     void sendToLoRa() {
-        if (!shouldSendToLoRa) return;
-        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BT TX", "%s", serialReceived.c_str());
-        displayShow("BT Tx >>", "", serialReceived, 1000);
-        LoRa_Utils::sendNewPacket(serialReceived);
-        shouldSendToLoRa = false;
+        static LoRaFrame frame;
+        if (btToLoRaQueue == NULL || xQueueReceive(btToLoRaQueue, &frame, 0) != pdTRUE) return;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BT TX", "%s", frame.data);
+        displayShow("BT Tx >>", "", frame.data, 1000);
+        StringView packet = {frame.data, frame.length};
+        TX_Utils::queuePacket(packet, TX_PRIORITY_MESSAGE);
     }
 
-    void sendToPhone(const String& packet) {
-        if (!packet.isEmpty()) {
+    void sendToPhone(const StringView& packet) {
+        if (packet.length > 0) {
             if (useKiss) {
-                logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BT RX Kiss", "%s", serialReceived.c_str());
-                SerialBT.print(KISS_Utils::encodeKISS(packet));
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BT RX Kiss", "%.*s", (int)packet.length, packet.data);
+                static uint8_t kissEncodedFrame[KISS_MAX_ENCODED_FRAME];
+                int length = KISS_Utils::encodeKISS(packet.data, packet.length, kissEncodedFrame, sizeof(kissEncodedFrame));
+                if (length > 0) SerialBT.write(kissEncodedFrame, length);
             } else {
-                logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BT RX TNC2", "%s", serialReceived.c_str());
-                SerialBT.println(packet);
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "BT RX TNC2", "%.*s", (int)packet.length, packet.data);
+                SerialBT.write((const uint8_t*)packet.data, packet.length);
+                SerialBT.println();
             }
         }
     }
 
+    void sendToPhone(const String& packet) {
+        StringView packetView = {packet.c_str(), packet.length()};
+        sendToPhone(packetView);
+    }
+
 }
\ No newline at end of file
@@ -17,9 +17,11 @@
  */
 
 #include <OneButton.h>
+#include <driver/gpio.h>
 #include "keyboard_utils.h"
 #include "configuration.h"
 #include "board_pinout.h"
+#include "scheduler_utils.h"
 #include "button_utils.h"
 #include "power_utils.h"
 #include "display.h"
@@ -82,6 +84,42 @@
             menuDisplay = 9000;
         }
 
+        void IRAM_ATTR buttonInterrupt() {     // wakes the scheduler, OneButton still does the decoding
+            SCHEDULER_Utils::signalEventFromISR(EVENT_KEY);
+        }
+
+        void setWakeup(uint8_t pin, bool enable) {
+            if (enable) {
+                gpio_intr_disable((gpio_num_t)pin);
+                gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_LOW_LEVEL);
+            } else {
+                gpio_wakeup_disable((gpio_num_t)pin);
+                gpio_set_intr_type((gpio_num_t)pin, GPIO_INTR_ANYEDGE);
+                gpio_intr_enable((gpio_num_t)pin);
+                if (digitalRead(pin) == LOW) SCHEDULER_Utils::signalEvent(EVENT_KEY);   // pressed while asleep
+            }
+        }
+
+        void prepareForLightSleep() {
+            if (Config.simplifiedTrackerMode) return;
+            setWakeup(BUTTON_PIN, true);
+            #ifdef RPC_Electronics_1W_LoRa_GPS
+                setWakeup(BUTTON2_PIN, true);
+                setWakeup(BUTTON3_PIN, true);
+                setWakeup(BUTTON4_PIN, true);
+            #endif
+        }
+
+        void resumeFromLightSleep() {
+            if (Config.simplifiedTrackerMode) return;
+            setWakeup(BUTTON_PIN, false);
+            #ifdef RPC_Electronics_1W_LoRa_GPS
+                setWakeup(BUTTON2_PIN, false);
+                setWakeup(BUTTON3_PIN, false);
+                setWakeup(BUTTON4_PIN, false);
+            #endif
+        }
+
         void loop() {
             if (!Config.simplifiedTrackerMode) {
                 userButton.tick();
@@ -99,10 +137,14 @@
                 userButton.attachLongPressStart(longPress1);
                 userButton.attachDoubleClick(doublePress1);
                 userButton.attachMultiClick(multiPress1);
+                attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), buttonInterrupt, CHANGE);
                 #ifdef RPC_Electronics_1W_LoRa_GPS
                     userButton2.attachClick(singlePress2);
                     userButton3.attachClick(singlePress3);
                     userButton4.attachClick(singlePress4);
+                    attachInterrupt(digitalPinToInterrupt(BUTTON2_PIN), buttonInterrupt, CHANGE);
+                    attachInterrupt(digitalPinToInterrupt(BUTTON3_PIN), buttonInterrupt, CHANGE);
+                    attachInterrupt(digitalPinToInterrupt(BUTTON4_PIN), buttonInterrupt, CHANGE);
                 #endif
             }
         }
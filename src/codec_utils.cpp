@@ -0,0 +1,195 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Pure encoders and position math of Utils, GPS_Utils, TELEMETRY_Utils and the BEACON_Utils
+// packet assembly: no hardware or globals, so the native test environment builds this file as well.
+
+#include <math.h>
+#include "telemetry_utils.h"
+#include "beacon_utils.h"
+#include "gps_utils.h"
+#include "utils.h"
+
+
+namespace Utils {
+
+    static char locator[11];    // letterize and getMaidenheadLocator functions are Copyright (c) 2021 Mateusz Salwach - MIT License
+
+    static char letterize(int x) {
+        return (char) x + 65;
+    }
+
+    char *getMaidenheadLocator(double lat, double lon, uint8_t size) {
+        double LON_F[]={20,2.0,0.083333,0.008333,0.0003472083333333333};
+        double LAT_F[]={10,1.0,0.0416665,0.004166,0.0001735833333333333};
+        int i;
+        lon += 180;
+        lat += 90;
+
+        if (size <= 0 || size > 10) size = 6;
+        size/=2; size*=2;
+
+        for (i = 0; i < size/2; i++) {
+            if (i % 2 == 1) {
+                locator[i*2] = (char) (lon/LON_F[i] + '0');
+                locator[i*2+1] = (char) (lat/LAT_F[i] + '0');
+            } else {
+                locator[i*2] = letterize((int) (lon/LON_F[i]));
+                locator[i*2+1] = letterize((int) (lat/LAT_F[i]));
+            }
+            lon = fmod(lon, LON_F[i]);
+            lat = fmod(lat, LAT_F[i]);
+        }
+        locator[i*2]=0;
+        return locator;
+    }
+
+}
+
+namespace GPS_Utils {
+
+    void setPositionContext(PositionContext& position, float latitude, float longitude) {
+        position.latitude       = latitude;
+        position.longitude      = longitude;
+        position.cosLatitude    = cosf(latitude * DEG_TO_RAD_F);
+        position.sinLatitude    = sinf(latitude * DEG_TO_RAD_F);
+        position.valid          = true;
+    }
+
+    static float getDeltaLongitude(const PositionContext& from, float longitude) {     // radians, across the antimeridian
+        float deltaLongitude = longitude - from.longitude;
+        if (deltaLongitude > 180.0f) deltaLongitude -= 360.0f;
+        if (deltaLongitude < -180.0f) deltaLongitude += 360.0f;
+        return deltaLongitude * DEG_TO_RAD_F;
+    }
+
+    // Equirectangular on the mean latitude. The course is taken at the midpoint, so it is turned
+    // back by half the meridian convergence to give the initial course as the great circle does.
+    void getFastDistanceCourse(const PositionContext& from, float latitude, float longitude, float& distanceKm, float& course) {
+        float deltaLongitude = getDeltaLongitude(from, longitude);
+        float x = deltaLongitude * cosf((latitude + from.latitude) * 0.5f * DEG_TO_RAD_F);
+        float y = (latitude - from.latitude) * DEG_TO_RAD_F;
+        distanceKm  = EARTH_RADIUS_KM * sqrtf(x * x + y * y);
+        course      = (atan2f(x, y) - deltaLongitude * from.sinLatitude * 0.5f) / DEG_TO_RAD_F;
+        if (course < 0.0f) course += 360.0f;
+    }
+
+    void getGreatCircleDistanceCourse(const PositionContext& from, float latitude, float longitude, float& distanceKm, float& course) {  // haversine + initial course
+        float deltaLatitude     = (latitude - from.latitude) * DEG_TO_RAD_F;
+        float deltaLongitude    = getDeltaLongitude(from, longitude);
+        float cosLatitude       = cosf(latitude * DEG_TO_RAD_F);
+        float sinLatitude       = sinf(latitude * DEG_TO_RAD_F);
+        float sinHalfLat        = sinf(deltaLatitude * 0.5f);
+        float sinHalfLng        = sinf(deltaLongitude * 0.5f);
+        float h = sinHalfLat * sinHalfLat + from.cosLatitude * cosLatitude * sinHalfLng * sinHalfLng;
+        distanceKm  = 2.0f * EARTH_RADIUS_KM * asinf(sqrtf(fminf(h, 1.0f)));
+        course      = atan2f(sinf(deltaLongitude) * cosLatitude, from.cosLatitude * sinLatitude - from.sinLatitude * cosLatitude * cosf(deltaLongitude)) / DEG_TO_RAD_F;
+        if (course < 0.0f) course += 360.0f;
+    }
+
+    void getDistanceCourse(const PositionContext& from, float latitude, float longitude, float& distanceKm, float& course) {
+        getFastDistanceCourse(from, latitude, longitude, distanceKm, course);
+        if (distanceKm > FAST_DISTANCE_LIMIT) getGreatCircleDistanceCourse(from, latitude, longitude, distanceKm, course);
+    }
+
+    String getCardinalDirection(float bearing) {
+        if (bearing >= 354.375 || bearing < 5.625)    return ">.NW.....(N).....NE.<"; // N
+        if (bearing >= 5.625 && bearing < 16.875)     return ">.......N.|.....NE..<";
+        if (bearing >= 16.875 && bearing < 28.125)    return ">.....N...|...NE....<"; // NEN
+        if (bearing >= 28.125 && bearing < 39.375)    return ">...N.....|.NE......<";
+        if (bearing >= 39.375 && bearing < 50.625)    return ">.N......(NE).....E.<"; // NE
+        if (bearing >= 50.625 && bearing < 61.875)    return ">.......NE|.....E...<";
+        if (bearing >= 61.875 && bearing < 73.125)    return ">.....NE..|...E.....<"; // ENE
+        if (bearing >= 73.125 && bearing < 84.375)    return ">...NE....|.E.......<";
+        if (bearing >= 84.375 && bearing < 95.625)    return ">.NE.....(E).....SE.<"; // E
+        if (bearing >= 95.625 && bearing < 106.875)   return ">.......E.|.....SE..<";
+        if (bearing >= 106.875 && bearing < 118.125)  return ">.....E...|...SE....<"; // ESE
+        if (bearing >= 118.125 && bearing < 129.375)  return ">...E.....|.SE......<";
+        if (bearing >= 129.375 && bearing < 140.625)  return ">.E......(SE).....S.<"; // SE
+        if (bearing >= 140.625 && bearing < 151.875)  return ">.......SE|.....S...<";
+        if (bearing >= 151.875 && bearing < 163.125)  return ">.....SE..|...S.....<"; // SES
+        if (bearing >= 163.125 && bearing < 174.375)  return ">...SE....|.S.......<";
+        if (bearing >= 174.375 && bearing < 185.625)  return ">.SE.....(S).....SW.<"; // S
+        if (bearing >= 185.625 && bearing < 196.875)  return ">.......S.|.....SW..<";
+        if (bearing >= 196.875 && bearing < 208.125)  return ">.....S...|...SW....<"; // SWS
+        if (bearing >= 208.125 && bearing < 219.375)  return ">...S.....|.SW......<";
+        if (bearing >= 219.375 && bearing < 230.625)  return ">.S......(SW).....W.<"; // SW
+        if (bearing >= 230.625 && bearing < 241.875)  return ">.......SW|.....W...<";
+        if (bearing >= 241.875 && bearing < 253.125)  return ">.....SW..|...W.....<"; // WSW
+        if (bearing >= 253.125 && bearing < 264.375)  return ">...SW....|.W.......<";
+        if (bearing >= 264.375 && bearing < 275.625)  return ">.SW.....(W).....NW.<"; // W
+        if (bearing >= 275.625 && bearing < 286.875)  return ">.......W.|.....NW..<";
+        if (bearing >= 286.875 && bearing < 298.125)  return ">.....W...|...NW....<"; // WNW
+        if (bearing >= 298.125 && bearing < 309.375)  return ">...W.....|.NW......<";
+        if (bearing >= 309.375 && bearing < 320.625)  return ">.W......(NW).....N.<"; // NW
+        if (bearing >= 320.625 && bearing < 331.875)  return ">.......NW|.....N...<";
+        if (bearing >= 331.875 && bearing < 343.125)  return ">.....NW..|...N.....<"; // NWN
+        if (bearing >= 343.125 && bearing < 354.375)  return ">...NW....|.N.......<";
+        return "";
+    }
+
+}
+
+namespace TELEMETRY_Utils {
+
+    String generateEncodedTelemetryBytes(float value, bool counterBytes, byte telemetryType) {
+        String encodedBytes;
+        int tempValue;
+
+        if (counterBytes) {
+            tempValue = value;
+        } else {
+            switch (telemetryType) {
+                case 0: tempValue = value * 100; break;         // Internal voltage (0-4,2V), Humidity, Gas calculation
+                case 1: tempValue = (value * 100) / 2; break;   // External voltage calculation (0-15V)
+                case 2: tempValue = (value * 10) + 500; break;  // Temperature
+                case 3: tempValue = (value * 8); break;         // Pressure
+                default: tempValue = value; break;
+            }
+        }
+
+        int firstByte   = tempValue / 91;
+        tempValue       -= firstByte * 91;
+
+        encodedBytes    = char(firstByte + 33);
+        encodedBytes    += char(tempValue + 33);
+        return encodedBytes;
+    }
+
+}
+
+namespace BEACON_Utils {
+
+    void clear(BeaconPacket& packet) {
+        packet.length   = 0;
+        packet.data[0]  = '\0';
+    }
+
+    void append(BeaconPacket& packet, const char* text, size_t length) {
+        if (packet.length + length >= BEACON_MAX_LENGTH) length = BEACON_MAX_LENGTH - 1 - packet.length;
+        memcpy(packet.data + packet.length, text, length);
+        packet.length += length;
+        packet.data[packet.length] = '\0';
+    }
+
+    void vappendf(BeaconPacket& packet, const char* format, va_list args) {
+        int written = vsnprintf(packet.data + packet.length, BEACON_MAX_LENGTH - packet.length, format, args);
+        if (written > 0) packet.length = min(packet.length + written, (size_t)BEACON_MAX_LENGTH - 1);
+    }
+
+}
@@ -17,113 +17,250 @@
  */
 
 #include <ArduinoJson.h>
-#include <SPIFFS.h>
+#include <esp_rom_crc.h>
 #include "configuration.h"
+#include "storage_utils.h"
 #include "board_pinout.h"
 #include "display.h"
 #include "logger.h"
 
 extern logging::Logger logger;
 
+/*  Snapshot layout:
+ *  [header: magic, version, CRC32 of the JSON it was compiled from, payload length, payload CRC32]
+ *  [payload: every field in visitSnapshot() order, strings NUL terminated]
+ *  Bump CONFIG_SNAPSHOT_VERSION whenever visitSnapshot() changes.
+ */
+#define CONFIG_SNAPSHOT_MAGIC       0x31464354  // "TCF1"
+#define CONFIG_SNAPSHOT_VERSION     4
+#define CONFIG_SNAPSHOT_MAX_ITEMS   16
+
+struct SnapshotHeader {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    reserved;
+    uint32_t    jsonCRC;
+    uint32_t    length;
+    uint32_t    crc;
+};
+
+uint32_t fileCRC(File& file) {     // from the current position to the end
+    uint8_t buffer[256];
+    uint32_t crc = 0;
+    size_t length;
+    while ((length = file.read(buffer, sizeof(buffer))) > 0) crc = esp_rom_crc32_le(crc, buffer, length);
+    return crc;
+}
+
+class SnapshotWriter {
+public:
+    std::vector<uint8_t>    data;
+
+    void raw(const void* value, size_t size) {
+        const uint8_t* bytes = (const uint8_t*)value;
+        data.insert(data.end(), bytes, bytes + size);
+    }
+    void field(bool& value)     { uint8_t flag = value ? 1 : 0; raw(&flag, 1); }
+    void field(uint8_t& value)  { raw(&value, sizeof(value)); }
+    void field(int& value)      { raw(&value, sizeof(value)); }
+    void field(long& value)     { raw(&value, sizeof(value)); }
+    void field(float& value)    { raw(&value, sizeof(value)); }
+    void field(String& value)   { raw(value.c_str(), value.length() + 1); }
+    void count(size_t& items)   { uint8_t value = items; raw(&value, 1); }
+};
+
+class SnapshotReader {
+public:
+    const uint8_t*  data;
+    size_t          length;
+    size_t          position;
+    bool            ok;
+
+    SnapshotReader(const uint8_t* buffer, size_t size) : data(buffer), length(size), position(0), ok(true) {}
+
+    void raw(void* value, size_t size) {
+        if (!ok || position + size > length) {
+            ok = false;
+            memset(value, 0, size);
+            return;
+        }
+        memcpy(value, data + position, size);
+        position += size;
+    }
+    void field(bool& value)     { uint8_t flag; raw(&flag, 1); value = flag != 0; }
+    void field(uint8_t& value)  { raw(&value, sizeof(value)); }
+    void field(int& value)      { raw(&value, sizeof(value)); }
+    void field(long& value)     { raw(&value, sizeof(value)); }
+    void field(float& value)    { raw(&value, sizeof(value)); }
+    void field(String& value) {
+        const uint8_t* end = ok ? (const uint8_t*)memchr(data + position, 0, length - position) : nullptr;
+        if (end == nullptr) {
+            ok = false;
+            value = "";
+            return;
+        }
+        value = (const char*)(data + position);
+        position = end - data + 1;
+    }
+    void count(size_t& items) {
+        uint8_t value;
+        raw(&value, 1);
+        if (value > CONFIG_SNAPSHOT_MAX_ITEMS) ok = false;
+        items = ok ? value : 0;
+    }
+};
+
+void Configuration::toJson(JsonDocument& data) {
+    data["wifiAP"]["active"]                    = wifiAP.active;
+    data["wifiAP"]["password"]                  = wifiAP.password;
+
+    for (int i = 0; i < beacons.size(); i++) {
+        beacons[i].callsign.trim();
+        beacons[i].callsign.toUpperCase();
+        data["beacons"][i]["callsign"]              = beacons[i].callsign;
+        data["beacons"][i]["symbol"]                = beacons[i].symbol;
+        data["beacons"][i]["overlay"]               = beacons[i].overlay;
+        data["beacons"][i]["micE"]                  = beacons[i].micE;
+        data["beacons"][i]["comment"]               = beacons[i].comment;
+        data["beacons"][i]["smartBeaconActive"]     = beacons[i].smartBeaconActive;
+        data["beacons"][i]["smartBeaconSetting"]    = beacons[i].smartBeaconSetting;
+        data["beacons"][i]["gpsEcoMode"]            = beacons[i].gpsEcoMode;
+        data["beacons"][i]["profileLabel"]          = beacons[i].profileLabel;
+        data["beacons"][i]["status"]                = beacons[i].status;
+    }
+
+    data["display"]["ecoMode"]                  = display.ecoMode;
+    data["display"]["timeout"]                  = display.timeout;
+    data["display"]["turn180"]                  = display.turn180;
+    data["display"]["showSymbol"]               = display.showSymbol;
+
+    data["bluetooth"]["active"]                 = bluetooth.active;
+    data["bluetooth"]["deviceName"]             = bluetooth.deviceName;
+    #ifdef HAS_BT_CLASSIC
+        data["bluetooth"]["useBLE"]             = bluetooth.useBLE;
+    #else
+        data["bluetooth"]["useBLE"]             = true; // fixed as BLE
+    #endif
+    data["bluetooth"]["useKISS"]                = bluetooth.useKISS;
+
+    for (int i = 0; i < loraTypes.size(); i++) {
+        data["lora"][i]["frequency"]                = loraTypes[i].frequency;
+        data["lora"][i]["spreadingFactor"]          = loraTypes[i].spreadingFactor;
+        data["lora"][i]["signalBandwidth"]          = loraTypes[i].signalBandwidth;
+        data["lora"][i]["codingRate4"]              = loraTypes[i].codingRate4;
+        data["lora"][i]["power"]                    = loraTypes[i].power;
+    }
+
+    data["battery"]["sendVoltage"]              = battery.sendVoltage;
+    data["battery"]["voltageAsTelemetry"]       = battery.voltageAsTelemetry;
+    data["battery"]["sendVoltageAlways"]        = battery.sendVoltageAlways;
+    data["battery"]["monitorVoltage"]           = battery.monitorVoltage;
+    data["battery"]["sleepVoltage"]             = battery.sleepVoltage;
+
+    data["telemetry"]["active"]                 = telemetry.active;
+    data["telemetry"]["sendTelemetry"]          = telemetry.sendTelemetry;
+    data["telemetry"]["temperatureCorrection"]  = telemetry.temperatureCorrection;
+
+    data["winlink"]["password"]                 = winlink.password;
+
+    data["notification"]["ledTx"]               = notification.ledTx;
+    data["notification"]["ledTxPin"]            = notification.ledTxPin;
+    data["notification"]["ledMessage"]          = notification.ledMessage;
+    data["notification"]["ledMessagePin"]       = notification.ledMessagePin;
+    data["notification"]["buzzerActive"]        = notification.buzzerActive;
+    data["notification"]["buzzerPinTone"]       = notification.buzzerPinTone;
+    data["notification"]["buzzerPinVcc"]        = notification.buzzerPinVcc;
+    data["notification"]["bootUpBeep"]          = notification.bootUpBeep;
+    data["notification"]["txBeep"]              = notification.txBeep;
+    data["notification"]["messageRxBeep"]       = notification.messageRxBeep;
+    data["notification"]["stationBeep"]         = notification.stationBeep;
+    data["notification"]["lowBatteryBeep"]      = notification.lowBatteryBeep;
+    data["notification"]["shutDownBeep"]        = notification.shutDownBeep;
+    data["notification"]["ledFlashlight"]       = notification.ledFlashlight;
+    data["notification"]["ledFlashlightPin"]    = notification.ledFlashlightPin;
+
+    data["pttTrigger"]["active"]                = ptt.active;
+    data["pttTrigger"]["reverse"]               = ptt.reverse;
+    data["pttTrigger"]["preDelay"]              = ptt.preDelay;
+    data["pttTrigger"]["postDelay"]             = ptt.postDelay;
+    data["pttTrigger"]["io_pin"]                = ptt.io_pin;
+
+    data["other"]["simplifiedTrackerMode"]      = simplifiedTrackerMode;
+    data["other"]["sendCommentAfterXBeacons"]   = sendCommentAfterXBeacons;
+    data["other"]["path"]                       = path;
+    data["other"]["nonSmartBeaconRate"]         = nonSmartBeaconRate;
+    data["other"]["rememberStationTime"]        = rememberStationTime;
+    data["other"]["standingUpdateTime"]         = standingUpdateTime;
+    data["other"]["dedupTime"]                  = dedupTime;
+    data["other"]["sendAltitude"]               = sendAltitude;
+    data["other"]["disableGPS"]                 = disableGPS;
+    data["other"]["packetLog"]                  = packetLog;
+    data["other"]["email"]                      = email;
+}
+
+struct ConfigSection {
+    const char* key;
+    uint16_t    section;
+};
+
+const ConfigSection configSections[] = {
+    {"wifiAP",          CONFIG_WIFI_AP},
+    {"beacons",         CONFIG_BEACONS},
+    {"display",         CONFIG_DISPLAY},
+    {"bluetooth",       CONFIG_BLUETOOTH},
+    {"lora",            CONFIG_LORA},
+    {"battery",         CONFIG_BATTERY},
+    {"telemetry",       CONFIG_TELEMETRY},
+    {"winlink",         CONFIG_WINLINK},
+    {"notification",    CONFIG_NOTIFICATION},
+    {"pttTrigger",      CONFIG_PTT},
+    {"other",           CONFIG_OTHER}
+};
+
+// Both configurations are rendered the way they would be saved, so a section only counts as
+// changed if its file contents would change.
+uint16_t Configuration::changedSections(Configuration& previous) {
+    JsonDocument current;
+    JsonDocument before;
+    toJson(current);
+    previous.toJson(before);
+
+    uint16_t changed = 0;
+    for (const ConfigSection& section : configSections) {
+        if (current[section.key].as<JsonVariantConst>() != before[section.key].as<JsonVariantConst>()) changed |= section.section;
+    }
+
+    const Notification& now = notification;
+    const Notification& old = previous.notification;
+    if (now.ledTx != old.ledTx || now.ledTxPin != old.ledTxPin ||
+        now.ledMessage != old.ledMessage || now.ledMessagePin != old.ledMessagePin ||
+        now.ledFlashlight != old.ledFlashlight || now.ledFlashlightPin != old.ledFlashlightPin ||
+        now.buzzerActive != old.buzzerActive || now.buzzerPinTone != old.buzzerPinTone || now.buzzerPinVcc != old.buzzerPinVcc ||
+        ptt.active != previous.ptt.active || ptt.io_pin != previous.ptt.io_pin || ptt.reverse != previous.ptt.reverse) {
+        changed |= CONFIG_PINS;
+    }
+    return changed;
+}
+
 bool Configuration::writeFile() {
 
     Serial.println("Saving config..");
 
     JsonDocument data;
-    File configFile = SPIFFS.open("/tracker_conf.json", "w");
+    File configFile = LittleFS.open("/tracker_conf.json", "w");
 
     if (!configFile) {
         Serial.println("Error: Could not open config file for writing");
         return false;
     }
     try {
-
-        data["wifiAP"]["active"]                    = wifiAP.active;
-        data["wifiAP"]["password"]                  = wifiAP.password;
-
-        for (int i = 0; i < beacons.size(); i++) {
-            beacons[i].callsign.trim();
-            beacons[i].callsign.toUpperCase();
-            data["beacons"][i]["callsign"]              = beacons[i].callsign;
-            data["beacons"][i]["symbol"]                = beacons[i].symbol;
-            data["beacons"][i]["overlay"]               = beacons[i].overlay;
-            data["beacons"][i]["micE"]                  = beacons[i].micE;
-            data["beacons"][i]["comment"]               = beacons[i].comment;
-            data["beacons"][i]["smartBeaconActive"]     = beacons[i].smartBeaconActive;
-            data["beacons"][i]["smartBeaconSetting"]    = beacons[i].smartBeaconSetting;
-            data["beacons"][i]["gpsEcoMode"]            = beacons[i].gpsEcoMode;
-            data["beacons"][i]["profileLabel"]          = beacons[i].profileLabel;
-            data["beacons"][i]["status"]                = beacons[i].status;
-        }
-
-        data["display"]["ecoMode"]                  = display.ecoMode;
-        data["display"]["timeout"]                  = display.timeout;
-        data["display"]["turn180"]                  = display.turn180;
-        data["display"]["showSymbol"]               = display.showSymbol;
-
-        data["bluetooth"]["active"]                 = bluetooth.active;
-        data["bluetooth"]["deviceName"]             = bluetooth.deviceName;
-        #ifdef HAS_BT_CLASSIC
-            data["bluetooth"]["useBLE"]             = bluetooth.useBLE;
-        #else
-            data["bluetooth"]["useBLE"]             = true; // fixed as BLE
-        #endif
-        data["bluetooth"]["useKISS"]                = bluetooth.useKISS;
-
-        for (int i = 0; i < loraTypes.size(); i++) {
-            data["lora"][i]["frequency"]                = loraTypes[i].frequency;
-            data["lora"][i]["spreadingFactor"]          = loraTypes[i].spreadingFactor;
-            data["lora"][i]["signalBandwidth"]          = loraTypes[i].signalBandwidth;
-            data["lora"][i]["codingRate4"]              = loraTypes[i].codingRate4;
-            data["lora"][i]["power"]                    = loraTypes[i].power;
-        }
-
-        data["battery"]["sendVoltage"]              = battery.sendVoltage;
-        data["battery"]["voltageAsTelemetry"]       = battery.voltageAsTelemetry;
-        data["battery"]["sendVoltageAlways"]        = battery.sendVoltageAlways;
-        data["battery"]["monitorVoltage"]           = battery.monitorVoltage;
-        data["battery"]["sleepVoltage"]             = battery.sleepVoltage;
-
-        data["telemetry"]["active"]                 = telemetry.active;
-        data["telemetry"]["sendTelemetry"]          = telemetry.sendTelemetry;
-        data["telemetry"]["temperatureCorrection"]  = telemetry.temperatureCorrection;
-
-        data["winlink"]["password"]                 = winlink.password;
-
-        data["notification"]["ledTx"]               = notification.ledTx;
-        data["notification"]["ledTxPin"]            = notification.ledTxPin;
-        data["notification"]["ledMessage"]          = notification.ledMessage;
-        data["notification"]["ledMessagePin"]       = notification.ledMessagePin;
-        data["notification"]["buzzerActive"]        = notification.buzzerActive;
-        data["notification"]["buzzerPinTone"]       = notification.buzzerPinTone;
-        data["notification"]["buzzerPinVcc"]        = notification.buzzerPinVcc;
-        data["notification"]["bootUpBeep"]          = notification.bootUpBeep;
-        data["notification"]["txBeep"]              = notification.txBeep;
-        data["notification"]["messageRxBeep"]       = notification.messageRxBeep;
-        data["notification"]["stationBeep"]         = notification.stationBeep;
-        data["notification"]["lowBatteryBeep"]      = notification.lowBatteryBeep;
-        data["notification"]["shutDownBeep"]        = notification.shutDownBeep;
-        data["notification"]["ledFlashlight"]       = notification.ledFlashlight;
-        data["notification"]["ledFlashlightPin"]    = notification.ledFlashlightPin;
-
-        data["pttTrigger"]["active"]                = ptt.active;
-        data["pttTrigger"]["reverse"]               = ptt.reverse;
-        data["pttTrigger"]["preDelay"]              = ptt.preDelay;
-        data["pttTrigger"]["postDelay"]             = ptt.postDelay;
-        data["pttTrigger"]["io_pin"]                = ptt.io_pin;
-
-        data["other"]["simplifiedTrackerMode"]      = simplifiedTrackerMode;
-        data["other"]["sendCommentAfterXBeacons"]   = sendCommentAfterXBeacons;
-        data["other"]["path"]                       = path;
-        data["other"]["nonSmartBeaconRate"]         = nonSmartBeaconRate;
-        data["other"]["rememberStationTime"]        = rememberStationTime;
-        data["other"]["standingUpdateTime"]         = standingUpdateTime;
-        data["other"]["sendAltitude"]               = sendAltitude;
-        data["other"]["disableGPS"]                 = disableGPS;
-        data["other"]["email"]                      = email;
+        toJson(data);
 
         serializeJson(data, configFile);
         configFile.close();
+        configFile = LittleFS.open("/tracker_conf.json", "r");
+        writeSnapshot(fileCRC(configFile));
+        configFile.close();
         return true;
     } catch (...) {
         Serial.println("Error: Exception occurred while saving config");
@@ -134,7 +271,7 @@ bool Configuration::writeFile() {
 
 bool Configuration::readFile() {
     Serial.println("Reading config..");
-    File configFile = SPIFFS.open("/tracker_conf.json", "r");
+    File configFile = LittleFS.open("/tracker_conf.json", "r");
 
     if (configFile) {
         bool needsRewrite = false;
@@ -271,8 +408,10 @@ bool Configuration::readFile() {
             data["other"]["nonSmartBeaconRate"].isNull() ||
             data["other"]["rememberStationTime"].isNull() ||
             data["other"]["standingUpdateTime"].isNull() ||
+            data["other"]["dedupTime"].isNull() ||
             data["other"]["sendAltitude"].isNull() ||
             data["other"]["disableGPS"].isNull() ||
+            data["other"]["packetLog"].isNull() ||
             data["other"]["email"].isNull()) needsRewrite = true;
         simplifiedTrackerMode           = data["other"]["simplifiedTrackerMode"] | false;
         sendCommentAfterXBeacons        = data["other"]["sendCommentAfterXBeacons"] | 10;
@@ -280,10 +419,14 @@ bool Configuration::readFile() {
         nonSmartBeaconRate              = data["other"]["nonSmartBeaconRate"] | 15;
         rememberStationTime             = data["other"]["rememberStationTime"] | 30;
         standingUpdateTime              = data["other"]["standingUpdateTime"] | 15;
+        dedupTime                       = data["other"]["dedupTime"] | 15;
         sendAltitude                    = data["other"]["sendAltitude"] | true;
         disableGPS                      = data["other"]["disableGPS"] | false;
+        packetLog                       = data["other"]["packetLog"] | false;
         email                           = data["other"]["email"] | "";
 
+        configFile.seek(0);
+        uint32_t jsonCRC = fileCRC(configFile);
         configFile.close();
 
         if (needsRewrite) {
@@ -292,6 +435,7 @@ bool Configuration::readFile() {
             delay(1000);
             ESP.restart();
         }
+        if (!error) writeSnapshot(jsonCRC);
         Serial.println("Config read successfuly");
         return true;
     } else {
@@ -403,25 +547,176 @@ void Configuration::setDefaultValues() {
     nonSmartBeaconRate              = 15;
     rememberStationTime             = 30;
     standingUpdateTime              = 15;
+    dedupTime                       = 15;
     sendAltitude                    = true;
     disableGPS                      = false;
+    packetLog                       = false;
     email                           = "";
 
     Serial.println("New Data Created... All is Written!");
 }
 
+template<typename T>
+void Configuration::visitSnapshot(T& io) {
+    io.field(wifiAP.active);
+    io.field(wifiAP.password);
+
+    size_t numBeacons = beacons.size();
+    io.count(numBeacons);
+    beacons.resize(numBeacons);
+    for (Beacon& beacon : beacons) {
+        io.field(beacon.callsign);
+        io.field(beacon.symbol);
+        io.field(beacon.overlay);
+        io.field(beacon.micE);
+        io.field(beacon.comment);
+        io.field(beacon.smartBeaconActive);
+        io.field(beacon.smartBeaconSetting);
+        io.field(beacon.gpsEcoMode);
+        io.field(beacon.profileLabel);
+        io.field(beacon.status);
+    }
+
+    io.field(display.showSymbol);
+    io.field(display.ecoMode);
+    io.field(display.timeout);
+    io.field(display.turn180);
+
+    io.field(battery.sendVoltage);
+    io.field(battery.voltageAsTelemetry);
+    io.field(battery.sendVoltageAlways);
+    io.field(battery.monitorVoltage);
+    io.field(battery.sleepVoltage);
+
+    io.field(winlink.password);
+
+    io.field(telemetry.active);
+    io.field(telemetry.sendTelemetry);
+    io.field(telemetry.temperatureCorrection);
+
+    io.field(notification.ledTx);
+    io.field(notification.ledTxPin);
+    io.field(notification.ledMessage);
+    io.field(notification.ledMessagePin);
+    io.field(notification.ledFlashlight);
+    io.field(notification.ledFlashlightPin);
+    io.field(notification.buzzerActive);
+    io.field(notification.buzzerPinTone);
+    io.field(notification.buzzerPinVcc);
+    io.field(notification.bootUpBeep);
+    io.field(notification.txBeep);
+    io.field(notification.messageRxBeep);
+    io.field(notification.stationBeep);
+    io.field(notification.lowBatteryBeep);
+    io.field(notification.shutDownBeep);
+
+    size_t numLoraTypes = loraTypes.size();
+    io.count(numLoraTypes);
+    loraTypes.resize(numLoraTypes);
+    for (LoraType& loraType : loraTypes) {
+        io.field(loraType.frequency);
+        io.field(loraType.spreadingFactor);
+        io.field(loraType.signalBandwidth);
+        io.field(loraType.codingRate4);
+        io.field(loraType.power);
+    }
+
+    io.field(ptt.active);
+    io.field(ptt.io_pin);
+    io.field(ptt.preDelay);
+    io.field(ptt.postDelay);
+    io.field(ptt.reverse);
+
+    io.field(bluetooth.active);
+    io.field(bluetooth.deviceName);
+    io.field(bluetooth.useBLE);
+    io.field(bluetooth.useKISS);
+
+    io.field(simplifiedTrackerMode);
+    io.field(sendCommentAfterXBeacons);
+    io.field(path);
+    io.field(email);
+    io.field(nonSmartBeaconRate);
+    io.field(rememberStationTime);
+    io.field(standingUpdateTime);
+    io.field(dedupTime);
+    io.field(sendAltitude);
+    io.field(disableGPS);
+    io.field(packetLog);
+}
+
+bool Configuration::writeSnapshot(uint32_t jsonCRC) {
+    SnapshotWriter writer;
+    visitSnapshot(writer);
+
+    SnapshotHeader header;
+    header.magic    = CONFIG_SNAPSHOT_MAGIC;
+    header.version  = CONFIG_SNAPSHOT_VERSION;
+    header.reserved = 0;
+    header.jsonCRC  = jsonCRC;
+    header.length   = writer.data.size();
+    header.crc      = esp_rom_crc32_le(0, writer.data.data(), writer.data.size());
+
+    File snapshotFile = LittleFS.open("/tracker_conf.bin", "w");
+    if (!snapshotFile) return false;
+    bool written =  snapshotFile.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                    snapshotFile.write(writer.data.data(), writer.data.size()) == writer.data.size();
+    snapshotFile.close();
+    if (!written) LittleFS.remove("/tracker_conf.bin");
+    return written;
+}
+
+// The snapshot is only trusted if it was compiled from the same JSON bytes (by CRC32, so an
+// edit that keeps the size is still caught) by the same snapshot version and its own CRC
+// matches; anything else falls back to parsing the JSON.
+bool Configuration::readSnapshot() {
+    File snapshotFile = LittleFS.open("/tracker_conf.bin", "r");
+    if (!snapshotFile) return false;
+
+    File configFile = LittleFS.open("/tracker_conf.json", "r");
+    uint32_t jsonCRC = configFile ? fileCRC(configFile) : 0;
+    configFile.close();
+
+    SnapshotHeader header;
+    bool valid =    snapshotFile.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                    header.magic == CONFIG_SNAPSHOT_MAGIC &&
+                    header.version == CONFIG_SNAPSHOT_VERSION &&
+                    header.jsonCRC == jsonCRC &&
+                    header.length == snapshotFile.size() - sizeof(header);
+    std::vector<uint8_t> payload;
+    if (valid) {
+        payload.resize(header.length);
+        valid = snapshotFile.read(payload.data(), payload.size()) == payload.size() &&
+                esp_rom_crc32_le(0, payload.data(), payload.size()) == header.crc;
+    }
+    snapshotFile.close();
+    if (!valid) {
+        Serial.println("Config snapshot outdated");
+        return false;
+    }
+
+    SnapshotReader reader(payload.data(), payload.size());
+    visitSnapshot(reader);
+    if (!reader.ok || reader.position != payload.size()) {
+        Serial.println("Config snapshot corrupt");
+        beacons.clear();
+        loraTypes.clear();
+        return false;
+    }
+    return true;
+}
+
 Configuration::Configuration() {
-    if (!SPIFFS.begin(false)) {
-        Serial.println("SPIFFS Mount Failed, formatting...");
+    loadedFromSnapshot  = false;
+    loadTime            = 0;
 
-        if (!SPIFFS.begin(true)) {
-            Serial.println("SPIFFS Format Failed");
-            return;
-        }
+    if (!STORAGE_Utils::mountFileSystem()) {
+        Serial.println("LittleFS Format Failed");
+        return;
     }
-    Serial.println("SPIFFS Ready");
+    Serial.println("LittleFS Ready");
 
-    if (!SPIFFS.exists("/tracker_conf.json")) {
+    if (!LittleFS.exists("/tracker_conf.json")) {
         Serial.println("Config not found, creating default...");
         setDefaultValues();
         writeFile();
@@ -429,5 +724,8 @@ Configuration::Configuration() {
         ESP.restart();
     }
 
-    readFile();
+    uint32_t loadStart  = micros();
+    loadedFromSnapshot  = readSnapshot();
+    if (!loadedFromSnapshot) readFile();
+    loadTime            = micros() - loadStart;
 }
\ No newline at end of file
@@ -84,6 +84,7 @@ extern Configuration    Config;
 extern Beacon           *currentBeacon;
 extern int              menuDisplay;
 extern bool             bluetoothConnected;
+extern bool             displayEcoMode;
 
 const char* symbolArray[]     = { "[", ">", "j", "b", "<", "s", "u", "R", "v", "(", ";", "-", "k",
                                 "C", "a", "Y", "O", "'", "=", "y", "U", "p", "_", ")"};
@@ -101,6 +102,25 @@ int         lastMenuDisplay         = 0;
 uint8_t     screenBrightness        = 1;    //from 1 to 255 to regulate brightness of screens
 bool        symbolAvailable         = true;
 
+uint32_t    overlayStartTime        = 0;    // displayShow(..., wait) keeps the screen for "wait" ms
+uint32_t    overlayDuration         = 0;
+
+struct ShownScreen {                        // what the panel is showing right now
+    String      rows[6];
+    uint8_t     layout;
+    int         symbolState;
+    uint32_t    topHeaderHash;
+    uint8_t     brightness;
+};
+ShownScreen shownScreen;
+
+#ifndef HAS_TFT
+    #define OLED_ADDRESS    0x3c
+    #define OLED_PAGES      8               // 64 rows / 8 bits per page
+    #define OLED_PAGE_SIZE  128
+    uint8_t     oledShadow[OLED_PAGES * OLED_PAGE_SIZE];    // last pushed frame buffer
+#endif
+
 extern logging::Logger logger;
 
 
@@ -230,8 +250,134 @@ extern logging::Logger logger;
 
 #endif
 
+void resetShownScreen() {
+    for (int i = 0; i < 6; i++) shownScreen.rows[i] = "";
+    shownScreen.layout          = 0;
+    shownScreen.symbolState     = -2;
+    shownScreen.topHeaderHash   = 0;
+    shownScreen.brightness      = 0;
+}
+
+bool displayOverlayActive() {
+    return millis() - overlayStartTime < overlayDuration;
+}
+
+void startOverlay(int wait) {
+    if (wait > 0) {
+        overlayStartTime    = millis();
+        overlayDuration     = wait;
+    }
+}
+
+uint32_t hashText(uint32_t hash, const String& text) {    // FNV-1a
+    for (unsigned int i = 0; i < text.length(); i++) {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+bool updateShownScreen(uint8_t layout, const String* const rows[], int rowCount, int symbolState) {
+    bool changed = shownScreen.layout != layout || shownScreen.symbolState != symbolState;
+    for (int i = 0; i < 6; i++) {
+        const String& row = (i < rowCount) ? *rows[i] : "";
+        if (shownScreen.rows[i] != row) {
+            shownScreen.rows[i] = row;
+            changed = true;
+        }
+    }
+    uint32_t topHeaderHash = 2166136261;
+    #if defined(TTGO_T_DECK_GPS) || defined(TTGO_T_DECK_PLUS)
+        topHeaderHash = hashText(topHeaderHash, topHeader1);
+        topHeaderHash = hashText(topHeaderHash, topHeader1_1);
+        topHeaderHash = hashText(topHeaderHash, topHeader1_2);
+        topHeaderHash = hashText(topHeaderHash, topHeader2);
+    #endif
+    if (shownScreen.topHeaderHash != topHeaderHash) {
+        shownScreen.topHeaderHash = topHeaderHash;
+        changed = true;
+    }
+    shownScreen.layout      = layout;
+    shownScreen.symbolState = symbolState;
+    return changed;
+}
+
+int getSymbolState() {      // -1: no symbol, symbol index, or 1000 + index when the BT icon is due
+    if (menuDisplay != 0 || !Config.display.showSymbol) return -1;
+    int symbol = 100;
+    for (int i = 0; i < symbolArraySize; i++) {
+        if (currentBeacon->symbol == symbolArray[i]) {
+            symbol = i;
+            break;
+        }
+    }
+
+    symbolAvailable = symbol != 100;
+
+    /*
+    * Symbol alternate every 5s
+    * If bluetooth is disconnected or if we are in the first part of the clock, then we show the APRS symbol
+    * Otherwise, we are in the second part of the clock, then we show BT connected
+    */
+    const auto time_now = now();
+    if (!bluetoothConnected || time_now % 10 < 5) {
+        return symbolAvailable ? symbol : -1;
+    } else {                // TODO In this case, the text symbol stay displayed due to symbolAvailable false in menu_utils
+        return 1000 + symbol;
+    }
+}
+
+#ifndef HAS_TFT
+    void applyBrightness() {
+        if (shownScreen.brightness == screenBrightness) return;
+        #ifdef ssd1306
+            display.ssd1306_command(SSD1306_SETCONTRAST);
+            display.ssd1306_command(screenBrightness);
+        #else
+            display.setContrast(screenBrightness);
+        #endif
+        shownScreen.brightness = screenBrightness;
+    }
+
+    void writePageData(const uint8_t* data) {
+        Wire.setClock(400000);                  // the Adafruit command helpers drop it back after each command
+        for (int i = 0; i < OLED_PAGE_SIZE; i += 32) {
+            Wire.beginTransmission(OLED_ADDRESS);
+            Wire.write(0x40);                   // data stream
+            Wire.write(data + i, 32);
+            Wire.endTransmission();
+        }
+    }
+
+    void pushDirtyPages() {     // only the 128 byte pages that differ from what the panel shows
+        uint8_t* buffer = display.getBuffer();
+        uint32_t wireClock = Wire.getClock();
+        for (int page = 0; page < OLED_PAGES; page++) {
+            uint8_t* pageData = buffer + page * OLED_PAGE_SIZE;
+            if (memcmp(pageData, oledShadow + page * OLED_PAGE_SIZE, OLED_PAGE_SIZE) == 0) continue;
+            #ifdef ssd1306
+                display.ssd1306_command(SSD1306_COLUMNADDR);
+                display.ssd1306_command(0);
+                display.ssd1306_command(OLED_PAGE_SIZE - 1);
+                display.ssd1306_command(SSD1306_PAGEADDR);
+                display.ssd1306_command(page);
+                display.ssd1306_command(page);
+            #else
+                display.oled_command(SH110X_SETPAGEADDR + page);
+                display.oled_command(0x10);     // SH1106 ram is 132 columns wide, panel starts at column 2
+                display.oled_command(0x02);
+            #endif
+            writePageData(pageData);
+            memcpy(oledShadow + page * OLED_PAGE_SIZE, pageData, OLED_PAGE_SIZE);
+        }
+        Wire.setClock(wireClock);
+    }
+#endif
+
+
 void displaySetup() {
     delay(500);
+    resetShownScreen();
     STATION_Utils::loadIndex(2);    // Screen Brightness value
     #ifdef HAS_TFT
         tft.init();
@@ -279,16 +425,25 @@ void displaySetup() {
         #endif
         display.setTextSize(1);
         display.setCursor(0, 0);
-        #ifdef ssd1306
-            display.ssd1306_command(SSD1306_SETCONTRAST);
-            display.ssd1306_command(screenBrightness);
-        #else
-            display.setContrast(screenBrightness);
-        #endif
+        applyBrightness();
         display.display();
+        memcpy(oledShadow, display.getBuffer(), sizeof(oledShadow));
     #endif
 }
 
+// Hot-apply of a changed display section: rotation and eco mode, the rest is read when used.
+void displayReconfigure() {
+    displayEcoMode = Config.display.ecoMode;
+    #ifdef HAS_TFT
+        tft.setRotation(Config.display.turn180 ? 3 : 1);
+        tft.fillScreen(TFT_BLACK);
+    #else
+        display.setRotation(Config.display.turn180 ? 2 : 0);
+        display.clearDisplay();
+    #endif
+    resetShownScreen();
+}
+
 void displayToggle(bool toggle) {
     if (toggle) {
         #ifdef HAS_TFT
@@ -314,6 +469,13 @@ void displayToggle(bool toggle) {
 }
 
 void displayShow(const String& header, const String& line1, const String& line2, int wait) {
+    startOverlay(wait);
+    const String* const rows[] = {&header, &line1, &line2};
+    #ifndef HAS_TFT
+        applyBrightness();
+    #endif
+    if (!updateShownScreen(3, rows, 3, -1)) return;     // nothing changed on screen
+
     #ifdef HAS_TFT
         #if defined(TTGO_T_DECK_GPS) || defined(TTGO_T_DECK_PLUS)
             draw_T_DECK_Top();
@@ -387,15 +549,8 @@ void displayShow(const String& header, const String& line1, const String& line2,
             display.setCursor(0, 16 + (10 * i));
             display.println(*lines[i]);
         }
-        #ifdef ssd1306
-            display.ssd1306_command(SSD1306_SETCONTRAST);
-            display.ssd1306_command(screenBrightness);
-        #else
-            display.setContrast(screenBrightness);
-        #endif
-        display.display();
+        pushDirtyPages();
     #endif
-    delay(wait);
 }
 
 void drawSymbol(int symbolIndex, bool bluetoothActive) {
@@ -414,6 +569,14 @@ void drawSymbol(int symbolIndex, bool bluetoothActive) {
 }
 
 void displayShow(const String& header, const String& line1, const String& line2, const String& line3, const String& line4, const String& line5, int wait) {
+    startOverlay(wait);
+    const String* const rows[] = {&header, &line1, &line2, &line3, &line4, &line5};
+    int symbolState = getSymbolState();
+    #ifndef HAS_TFT
+        applyBrightness();
+    #endif
+    if (!updateShownScreen(6, rows, 6, symbolState)) return;     // nothing changed on screen
+
     #ifdef HAS_TFT
         #if defined(TTGO_T_DECK_GPS) || defined(TTGO_T_DECK_PLUS)
             draw_T_DECK_Top();
@@ -472,27 +635,10 @@ void displayShow(const String& header, const String& line1, const String& line2,
                 }
             }
         #endif
-            if (menuDisplay == 0 && Config.display.showSymbol) {
-                int symbol = 100;
-                for (int i = 0; i < symbolArraySize; i++) {
-                    if (currentBeacon->symbol == symbolArray[i]) {
-                        symbol = i;
-                        break;
-                    }
-                }
-
-                symbolAvailable = symbol != 100;
-
-                /*  Symbol alternate every 5s
-                *   If bluetooth is disconnected or if we are in the first part of the clock, then we show the APRS symbol
-                *   Otherwise, we are in the second part of the clock, then we show BT connected */
-
-                const auto time_now = now();
-                if (!bluetoothConnected || time_now % 10 < 5) {
-                    if (symbolAvailable) drawSymbol(symbol, false);
-                } else if (bluetoothConnected) {    // TODO In this case, the text symbol stay displayed due to symbolAvailable false in menu_utils
-                    drawSymbol(symbol, true);
-                }
+            if (symbolState >= 1000) {
+                drawSymbol(symbolState - 1000, true);
+            } else if (symbolState >= 0) {
+                drawSymbol(symbolState, false);
             }
         sprite.pushSprite(0,0);
     #else
@@ -516,39 +662,14 @@ void displayShow(const String& header, const String& line1, const String& line2,
             display.setCursor(0, 20 + (9 * i));
             display.println(*lines[i]);
         }
-        #ifdef ssd1306
-            display.ssd1306_command(SSD1306_SETCONTRAST);
-            display.ssd1306_command(screenBrightness);
-        #else
-            display.setContrast(screenBrightness);
-        #endif
 
-        if (menuDisplay == 0 && Config.display.showSymbol) {
-            int symbol = 100;
-            for (int i = 0; i < symbolArraySize; i++) {
-                if (currentBeacon->symbol == symbolArray[i]) {
-                    symbol = i;
-                    break;
-                }
-            }
-
-            symbolAvailable = symbol != 100;
-
-            /*
-            * Symbol alternate every 5s
-            * If bluetooth is disconnected or if we are in the first part of the clock, then we show the APRS symbol
-            * Otherwise, we are in the second part of the clock, then we show BT connected
-            */
-            const auto time_now = now();
-            if (!bluetoothConnected || time_now % 10 < 5) {
-                if (symbolAvailable) drawSymbol(symbol, false);
-            } else if (bluetoothConnected) {    // TODO In this case, the text symbol stay displayed due to symbolAvailable false in menu_utils
-                drawSymbol(symbol, true);
-            }
+        if (symbolState >= 1000) {
+            drawSymbol(symbolState - 1000, true);
+        } else if (symbolState >= 0) {
+            drawSymbol(symbolState, false);
         }
-        display.display();
+        pushDirtyPages();
     #endif
-    delay(wait);
 }
 
 void startupScreen(uint8_t index, const String& version) {
@@ -17,14 +17,17 @@
  */
 
 #include <TinyGPS++.h>
+#include <atomic>
 #include "TimeLib.h"
 #include <APRSPacketLib.h>
 #include "smartbeacon_utils.h"
+#include "airtime_utils.h"
 #include "configuration.h"
 #include "station_utils.h"
 #include "board_pinout.h"
 #include "power_utils.h"
 #include "sleep_utils.h"
+#include "scheduler_utils.h"
 #include "gps_utils.h"
 #include "display.h"
 #include "logger.h"
@@ -35,6 +38,10 @@
 #else
     #define GPS_BAUD    9600
 #endif
+#define GPS_UART_BUFFER     1024    // driver side, covers long loop() passes
+#define NMEA_RING_SIZE      1024    // filtered sentences waiting for getData()
+#define NMEA_MAX_LENGTH     96      // 82 by the standard, some receivers go beyond
+#define POSITION_MOVE_LIMIT 0.02f   // km moved before heard stations are recalculated
 
 
 extern Configuration        Config;
@@ -61,9 +68,139 @@ float       bearing         = 0;
 
 bool        gpsIsActive     = true;
 
+// single producer (UART event task) / single consumer (loop) ring of filtered sentences
+char                    nmeaRing[NMEA_RING_SIZE];
+std::atomic<uint16_t>   nmeaRingHead(0);
+std::atomic<uint16_t>   nmeaRingTail(0);
+char                    nmeaLine[NMEA_MAX_LENGTH + 2];
+uint8_t                 nmeaLineLength  = 0;
+bool                    nmeaLineValid   = false;
+GPSIngestStats          gpsIngestStats  = {0, 0, 0, 0};
+
+PositionContext         ownPosition     = {0.0, 0.0, 1.0, 0.0, false};    // refreshed on GPS fix updates
+
 
 namespace GPS_Utils {
 
+    uint8_t hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return 0xFF;
+    }
+
+    bool checkNMEAChecksum(const char *line, uint8_t length) {     // "$...*hh"
+        uint8_t checksum = 0;
+        uint8_t i = 1;
+        while (i < length && line[i] != '*') checksum ^= line[i++];
+        if (i + 2 >= length) return false;     // '*' and two hex digits
+        uint8_t high = hexValue(line[i + 1]);
+        uint8_t low  = hexValue(line[i + 2]);
+        return high != 0xFF && low != 0xFF && ((high << 4) | low) == checksum;
+    }
+
+    bool isParsedSentence(const char *line, uint8_t length) {      // what TinyGPS++ decodes: $--GGA / $--RMC
+        if (length < 7) return false;
+        return (line[3] == 'G' && line[4] == 'G' && line[5] == 'A') || (line[3] == 'R' && line[4] == 'M' && line[5] == 'C');
+    }
+
+    void pushSentence(const char *line, uint8_t length) {
+        uint16_t head = nmeaRingHead.load(std::memory_order_relaxed);
+        uint16_t tail = nmeaRingTail.load(std::memory_order_acquire);
+        uint16_t freeSpace = (tail + NMEA_RING_SIZE - head - 1) % NMEA_RING_SIZE;
+        if (length + 2 > freeSpace) {
+            gpsIngestStats.overflowed++;
+            return;
+        }
+        for (uint8_t i = 0; i < length; i++) {
+            nmeaRing[head] = line[i];
+            head = (head + 1) % NMEA_RING_SIZE;
+        }
+        nmeaRing[head] = '\r';
+        head = (head + 1) % NMEA_RING_SIZE;
+        nmeaRing[head] = '\n';
+        head = (head + 1) % NMEA_RING_SIZE;
+        nmeaRingHead.store(head, std::memory_order_release);
+    }
+
+    void filterNMEA(char c) {
+        if (c == '$') {
+            nmeaLine[0]     = c;
+            nmeaLineLength  = 1;
+            nmeaLineValid   = true;
+        } else if (c == '\r' || c == '\n') {
+            if (nmeaLineValid && nmeaLineLength > 1) {
+                if (!isParsedSentence(nmeaLine, nmeaLineLength)) {
+                    gpsIngestStats.dropped++;
+                } else if (!checkNMEAChecksum(nmeaLine, nmeaLineLength)) {
+                    gpsIngestStats.checksumFailed++;
+                } else {
+                    gpsIngestStats.passed++;
+                    pushSentence(nmeaLine, nmeaLineLength);
+                }
+            }
+            nmeaLineValid = false;
+        } else if (nmeaLineValid) {
+            if (nmeaLineLength < NMEA_MAX_LENGTH) {
+                nmeaLine[nmeaLineLength++] = c;
+            } else {
+                gpsIngestStats.dropped++;
+                nmeaLineValid = false;
+            }
+        }
+    }
+
+    void onGPSReceive() {       // UART event task
+        while (gpsSerial.available() > 0) filterNMEA(gpsSerial.read());
+        SLEEP_Utils::gpsDataReceived();
+        SCHEDULER_Utils::signalEvent(EVENT_GPS_DATA);
+    }
+
+    void sendNMEACommand(const char *body) {    // "$<body>*hh"
+        uint8_t checksum = 0;
+        for (const char *p = body; *p != '\0'; p++) checksum ^= *p;
+        gpsSerial.printf("$%s*%02X\r\n", body, checksum);
+    }
+
+    void sendUBX(uint8_t msgClass, uint8_t msgId, const uint8_t *payload, uint16_t length) {
+        uint8_t header[6] = {0xB5, 0x62, msgClass, msgId, (uint8_t)(length & 0xFF), (uint8_t)(length >> 8)};
+        uint8_t checksumA = 0, checksumB = 0;
+        for (int i = 2; i < 6; i++) {
+            checksumA += header[i];
+            checksumB += checksumA;
+        }
+        for (int i = 0; i < length; i++) {
+            checksumA += payload[i];
+            checksumB += checksumA;
+        }
+        gpsSerial.write(header, sizeof(header));
+        gpsSerial.write(payload, length);
+        gpsSerial.write(checksumA);
+        gpsSerial.write(checksumB);
+    }
+
+    void disableUnusedSentences() {     // each receiver family ignores the other commands
+        const uint8_t unusedSentences[] = {0x01, 0x02, 0x03, 0x05};    // GLL, GSA, GSV, VTG
+        for (uint8_t i = 0; i < sizeof(unusedSentences); i++) {
+            const uint8_t cfgMsg[3] = {0xF0, unusedSentences[i], 0x00};     // UBX CFG-MSG, rate 0 on this port
+            sendUBX(0x06, 0x01, cfgMsg, sizeof(cfgMsg));
+            delay(10);
+        }
+        sendNMEACommand("PMTK314,0,1,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0");  // MediaTek: RMC + GGA
+        sendNMEACommand("PCAS03,1,0,0,0,1,0,0,0,0,0,,,0,0");               // AT6558/L76K: GGA + RMC
+        gpsSerial.flush();
+    }
+
+    GPSIngestStats getIngestStats() {
+        return gpsIngestStats;
+    }
+
+    void logIngestStats() {
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "GPS", "NMEA passed: %u dropped: %u checksum failed: %u overflowed: %u",
+                    (unsigned int)gpsIngestStats.passed, (unsigned int)gpsIngestStats.dropped,
+                    (unsigned int)gpsIngestStats.checksumFailed, (unsigned int)gpsIngestStats.overflowed);
+    }
+
     void setup() {
         if (disableGPS) {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Main", "GPS disabled");
@@ -80,19 +217,43 @@ namespace GPS_Utils {
             delay(200);
         #endif
 
+        gpsSerial.setRxBufferSize(GPS_UART_BUFFER);     // before begin()
         gpsSerial.begin(GPS_BAUD, SERIAL_8N1, GPS_TX, GPS_RX);
+        gpsSerial.onReceive(onGPSReceive);
+        disableUnusedSentences();
+    }
+
+    void getDistanceCourse(float latitude, float longitude, float& distanceKm, float& course) {  // from own position
+        getDistanceCourse(ownPosition, latitude, longitude, distanceKm, course);
+    }
+
+    void updatePositionContext() {      // on gps.location updates
+        float latitude  = gps.location.lat();
+        float longitude = gps.location.lng();
+        if (ownPosition.valid) {
+            float movedKm, course;
+            getDistanceCourse(latitude, longitude, movedKm, course);
+            if (movedKm < POSITION_MOVE_LIMIT) return;
+        }
+        setPositionContext(ownPosition, latitude, longitude);
+        STATION_Utils::recalculateDistances();
     }
 
     void calculateDistanceCourse(const String& callsign, double checkpointLatitude, double checkPointLongitude) {
-        double distanceKm = TinyGPSPlus::distanceBetween(gps.location.lat(), gps.location.lng(), checkpointLatitude, checkPointLongitude) / 1000.0;
-        double courseTo   = TinyGPSPlus::courseTo(gps.location.lat(), gps.location.lng(), checkpointLatitude, checkPointLongitude);
-        STATION_Utils::deleteListenedStationsByTime();
-        STATION_Utils::orderListenedStationsByDistance(callsign, distanceKm, courseTo);
+        float distanceKm, course;
+        getDistanceCourse(checkpointLatitude, checkPointLongitude, distanceKm, course);
+        STATION_Utils::orderListenedStationsByDistance(callsign, checkpointLatitude, checkPointLongitude, distanceKm, course);
     }
 
     void getData() {
         if (disableGPS) return;
-        while (gpsSerial.available() > 0) gps.encode(gpsSerial.read());
+        uint16_t tail = nmeaRingTail.load(std::memory_order_relaxed);
+        uint16_t head = nmeaRingHead.load(std::memory_order_acquire);
+        while (tail != head) {
+            gps.encode(nmeaRing[tail]);
+            tail = (tail + 1) % NMEA_RING_SIZE;
+        }
+        nmeaRingTail.store(tail, std::memory_order_release);
     }
 
     void setDateFromData() {
@@ -121,7 +282,7 @@ namespace GPS_Utils {
     void calculateHeadingDelta(int speed) {
         uint8_t TurnMinAngle;
         double headingDelta = abs(previousHeading - currentHeading);
-        if (lastTx > currentSmartBeaconValues.minDeltaBeacon * 1000) {
+        if (lastTx > currentSmartBeaconValues.minDeltaBeacon * 1000 * AIRTIME_Utils::getBeaconBackoff()) {
             if (speed == 0) {
                 TurnMinAngle = currentSmartBeaconValues.turnMinDeg + (currentSmartBeaconValues.turnSlope/(speed + 1));
             } else {
@@ -159,42 +320,9 @@ namespace GPS_Utils {
         return bearing;
     }
 
-    String getCardinalDirection(float course) {
+    float getBearing(float course) {   // course over ground is only trusted while moving
         if (gps.speed.kmph() > 0.5) bearing = course;
-
-        if (bearing >= 354.375 || bearing < 5.625)    return ">.NW.....(N).....NE.<"; // N
-        if (bearing >= 5.675 && bearing < 16.875)     return ">.......N.|.....NE..<";
-        if (bearing >= 16.875 && bearing < 28.125)    return ">.....N...|...NE....<"; // NEN
-        if (bearing >= 28.125 && bearing < 39.375)    return ">...N.....|.NE......<";
-        if (bearing >= 39.375 && bearing < 50.625)    return ">.N......(NE).....E.<"; // NE
-        if (bearing >= 50.625 && bearing < 61.875)    return ">.......NE|.....E...<";
-        if (bearing >= 61.875 && bearing < 73.125)    return ">.....NE..|...E.....<"; // ENE
-        if (bearing >= 73.125 && bearing < 84.375)    return ">...NE....|.E.......<";
-        if (bearing >= 84.375 && bearing < 95.625)    return ">.NE.....(E).....SE.<"; // E
-        if (bearing >= 95.625 && bearing < 106.875)   return ">.......E.|.....SE..<";
-        if (bearing >= 106.875 && bearing < 118.125)  return ">.....E...|...SE....<"; // ESE
-        if (bearing >= 118.125 && bearing < 129.375)  return ">...E.....|.SE......<";
-        if (bearing >= 129.375 && bearing < 140.625)  return ">.E......(SE).....S.<"; // SE
-        if (bearing >= 140.625 && bearing < 151.875)  return ">.......SE|.....S...<";
-        if (bearing >= 151.875 && bearing < 163.125)  return ">.....SE..|...S.....<"; // SES
-        if (bearing >= 163.125 && bearing < 174.375)  return ">...SE....|.S.......<";
-        if (bearing >= 174.375 && bearing < 185.625)  return ">.SE.....(S).....SW.<"; // S
-        if (bearing >= 185.625 && bearing < 196.875)  return ">.......S.|.....SW..<";
-        if (bearing >= 196.875 && bearing < 208.125)  return ">.....S...|...SW....<"; // SWS
-        if (bearing >= 208.125 && bearing < 219.375)  return ">...S.....|.SW......<";
-        if (bearing >= 219.375 && bearing < 230.625)  return ">.S......(SW).....W.<"; // SW
-        if (bearing >= 230.625 && bearing < 241.875)  return ">.......SW|.....W...<";
-        if (bearing >= 241.875 && bearing < 253.125)  return ">.....SW..|...W.....<"; // WSW
-        if (bearing >= 253.125 && bearing < 264.375)  return ">...SW....|.W.......<";
-        if (bearing >= 264.375 && bearing < 275.625)  return ">.SW.....(W).....NW.<"; // W
-        if (bearing >= 275.625 && bearing < 286.875)  return ">.......W.|.....NW..<";
-        if (bearing >= 286.875 && bearing < 298.125)  return ">.....W...|...NW....<"; // WNW
-        if (bearing >= 298.125 && bearing < 309.375)  return ">...W.....|.NW......<";
-        if (bearing >= 309.375 && bearing < 320.625)  return ">.W......(NW).....N.<"; // NW
-        if (bearing >= 320.625 && bearing < 331.875)  return ">.......NW|.....N...<";
-        if (bearing >= 331.875 && bearing < 343.125)  return ">.....NW..|...N.....<"; // NWN
-        if (bearing >= 343.125 && bearing < 354.375)  return ">...NW....|.N.......<";
-        return "";
+        return bearing;
     }
 
 }
\ No newline at end of file
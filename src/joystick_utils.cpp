@@ -20,6 +20,7 @@
 #include "configuration.h"
 #include "keyboard_utils.h"
 #include "board_pinout.h"
+#include "scheduler_utils.h"
 #include "button_utils.h"
 
 extern  int                     menuDisplay;
@@ -53,7 +54,7 @@ typedef void (*DirectionFunc)();
             }
         }
 
-        void loop() {   // for running process with SPIFFS outside interrupt
+        void loop() {   // for running process with LittleFS outside interrupt
             if (checkMenuDisplayToExitInterrupt(menuDisplay) && exitJoystickInterrupt) BUTTON_Utils::longPress1();
         }
 
@@ -65,6 +66,7 @@ typedef void (*DirectionFunc)();
                     exitJoystickInterrupt = false;
                     directionFunc();
                 }
+                SCHEDULER_Utils::signalEventFromISR(EVENT_KEY);
             }
         }
 
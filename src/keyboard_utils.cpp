@@ -22,11 +22,14 @@
 #include <Wire.h>
 #include "keyboard_utils.h"
 #include "winlink_utils.h"
+#include "beacon_utils.h"
 #include "station_utils.h"
 #include "configuration.h"
 #include "board_pinout.h"
 #include "power_utils.h"
 #include "sleep_utils.h"
+#include "tx_utils.h"
+#include "storage_utils.h"
 #include "menu_utils.h"
 #include "msg_utils.h"
 #include "display.h"
@@ -53,7 +56,6 @@ extern int              messagesIterator;
 extern bool             messageLed;
 extern String           messageCallsign;
 extern String           messageText;
-extern bool             sendStandingUpdate;
 extern bool             flashlight;
 extern bool             digipeaterActive;
 extern bool             sosActive;
@@ -69,8 +71,6 @@ extern bool             gpsIsActive;
 extern bool             sendStartTelemetry;
 extern uint8_t          keyboardAddress;
 
-extern std::vector<String>  outputMessagesBuffer;
-
 bool        keyboardConnected       = false;
 bool        keyDetected             = false;
 uint32_t    keyboardTime            = millis();
@@ -116,9 +116,9 @@ namespace KEYBOARD_Utils {
             if (menuDisplay < 30) menuDisplay = 33;
         }
 
-        else if (menuDisplay >= 40 && menuDisplay <= 41) {
+        else if (menuDisplay >= 40 && menuDisplay <= 42) {
             menuDisplay--;
-            if (menuDisplay < 40) menuDisplay = 41;
+            if (menuDisplay < 40) menuDisplay = 42;
         }
 
         else if (menuDisplay >= 50 && menuDisplay <= 53) {
@@ -202,9 +202,9 @@ namespace KEYBOARD_Utils {
             if (menuDisplay > 33) menuDisplay = 30;
         }
 
-        else if (menuDisplay >= 40 && menuDisplay <= 41) {
+        else if (menuDisplay >= 40 && menuDisplay <= 42) {
             menuDisplay++;
-            if (menuDisplay > 41) menuDisplay = 40;
+            if (menuDisplay > 42) menuDisplay = 40;
         }
 
         else if (menuDisplay >= 50 && menuDisplay <= 53) {
@@ -263,7 +263,7 @@ namespace KEYBOARD_Utils {
         } else if (menuDisplay == 1300 ||  menuDisplay == 1310) {
             messageText = "";
             menuDisplay = menuDisplay/10;
-        } else if ((menuDisplay>=10 && menuDisplay<=13) || (menuDisplay>=20 && menuDisplay<=29) || (menuDisplay == 120) || (menuDisplay>=130 && menuDisplay<=133) || (menuDisplay>=50 && menuDisplay<=53) || (menuDisplay>=200 && menuDisplay<=290) || (menuDisplay>=2210 && menuDisplay<=2212) || (menuDisplay>=60 && menuDisplay<=64) || (menuDisplay>=30 && menuDisplay<=33) || (menuDisplay>=40 && menuDisplay<=41) || (menuDisplay>=400 && menuDisplay<=410)) {
+        } else if ((menuDisplay>=10 && menuDisplay<=13) || (menuDisplay>=20 && menuDisplay<=29) || (menuDisplay == 120) || (menuDisplay>=130 && menuDisplay<=133) || (menuDisplay>=50 && menuDisplay<=53) || (menuDisplay>=200 && menuDisplay<=290) || (menuDisplay>=2210 && menuDisplay<=2212) || (menuDisplay>=60 && menuDisplay<=64) || (menuDisplay>=30 && menuDisplay<=33) || (menuDisplay>=40 && menuDisplay<=42) || (menuDisplay>=400 && menuDisplay<=420)) {
             menuDisplay = int(menuDisplay/10);
         } else if (menuDisplay == 5000 || menuDisplay == 5010 || menuDisplay == 5020 || menuDisplay == 5030 || menuDisplay == 5040 || menuDisplay == 5050 || menuDisplay == 5060 || menuDisplay == 5070 || menuDisplay == 5080) {
             menuDisplay = 5;
@@ -324,7 +324,7 @@ namespace KEYBOARD_Utils {
             STATION_Utils::saveIndex(0, myBeaconsIndex);
             sendStartTelemetry = true;
             if (menuDisplay == 200) menuDisplay = 20;
-        } else if ((menuDisplay >= 1 && menuDisplay <= 6) || (menuDisplay >= 11 &&menuDisplay <= 13) || (menuDisplay >= 20 && menuDisplay <= 27) || (menuDisplay >= 40 && menuDisplay <= 41)) {
+        } else if ((menuDisplay >= 1 && menuDisplay <= 6) || (menuDisplay >= 11 &&menuDisplay <= 13) || (menuDisplay >= 20 && menuDisplay <= 27) || (menuDisplay >= 40 && menuDisplay <= 42)) {
             menuDisplay = menuDisplay * 10;
         } else if (menuDisplay == 10) {
             MSG_Utils::loadMessagesFromMemory(0);
@@ -552,6 +552,7 @@ namespace KEYBOARD_Utils {
             displayShow("", "", "  STARTING WiFi AP", 2000);
             Config.wifiAP.active = true;
             Config.writeFile();
+            delay(2000);
             ESP.restart();
         }
     }
@@ -620,6 +621,8 @@ namespace KEYBOARD_Utils {
             }
         } else if (menuDisplay == 260 && key == 13) {
             displayShow("", "", "    REBOOTING ...", 2000);
+            STORAGE_Utils::flush(true);
+            delay(2000);
             ESP.restart();
         } else if (menuDisplay == 270 && key == 13) {
             #if defined(HAS_AXP192) || defined(HAS_AXP2101)
@@ -753,10 +756,11 @@ namespace KEYBOARD_Utils {
             } else if (key == 13 && messageText.length() > 0) {
                 messageText.trim();
                 if (messageText.length() > 67) messageText = messageText.substring(0, 67);
-                String packet = APRSPacketLib::generateBase91GPSBeaconPacket(currentBeacon->callsign, "APLRT1", Config.path, currentBeacon->overlay, APRSPacketLib::encodeGPSIntoBase91(gps.location.lat(),gps.location.lng(), gps.course.deg(), gps.speed.knots(), currentBeacon->symbol, Config.sendAltitude, gps.altitude.feet(), sendStandingUpdate));
-                packet += messageText;
+                BEACON_Utils::startPosition(true);
+                BEACON_Utils::append(messageText);
+                String packet = BEACON_Utils::finish();
                 displayShow("<<< TX >>>", "", packet,100);
-                LoRa_Utils::sendNewPacket(packet);
+                TX_Utils::queuePacket(packet, TX_PRIORITY_MESSAGE);
                 messageText = "";
                 menuDisplay = 63;
             } else if (key == 8) {
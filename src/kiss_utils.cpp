@@ -19,155 +19,232 @@
 #include "kiss_utils.h"
 
 
+KissDeframer::KissDeframer() {
+    reset();
+}
+
+void KissDeframer::reset() {
+    bufferLength    = 0;
+    frameLength     = 0;
+    state           = WaitFend;
+}
+
+bool KissDeframer::feed(uint8_t byte) {
+    if (byte == KissChar::FEND) {                       // closes the current frame and opens the next one
+        bool frameReady = (state == InFrame && bufferLength > 0);
+        frameLength     = frameReady ? bufferLength : 0;
+        bufferLength    = 0;
+        state           = InFrame;
+        return frameReady;
+    }
+    switch (state) {
+        case WaitFend:                                  // leading bytes before any FEND
+        case Discard:                                   // corrupted or oversized frame
+            return false;
+        case Escape:
+            if (byte == KissChar::TFEND) {
+                byte = KissChar::FEND;
+            } else if (byte == KissChar::TFESC) {
+                byte = KissChar::FESC;
+            } else {
+                state = Discard;
+                return false;
+            }
+            state = InFrame;
+            break;
+        case InFrame:
+            if (byte == KissChar::FESC) {
+                state = Escape;
+                return false;
+            }
+            break;
+    }
+    if (bufferLength >= KISS_MAX_FRAME) {
+        state = Discard;
+        return false;
+    }
+    buffer[bufferLength++] = byte;
+    return false;
+}
+
+bool KissDeframer::isReceiving() const {
+    return (state == InFrame && bufferLength > 0) || state == Escape || state == Discard;
+}
+
+uint8_t KissDeframer::command() const {
+    return buffer[0];
+}
+
+const uint8_t* KissDeframer::data() const {
+    return buffer + 1;
+}
+
+size_t KissDeframer::length() const {
+    return frameLength > 0 ? frameLength - 1 : 0;
+}
+
+
 namespace KISS_Utils {
 
-    bool validateTNC2Frame(const String& tnc2FormattedFrame) {
-        int colonPos        = tnc2FormattedFrame.indexOf(':');
-        int greaterThanPos  = tnc2FormattedFrame.indexOf('>');
-        return (colonPos != -1) && (greaterThanPos != -1) && (colonPos > greaterThanPos);
+    bool validateTNC2Frame(const char* tnc2FormattedFrame, size_t length) {
+        const char* colonPos        = (const char*)memchr(tnc2FormattedFrame, ':', length);
+        const char* greaterThanPos  = (const char*)memchr(tnc2FormattedFrame, '>', length);
+        return (colonPos != nullptr) && (greaterThanPos != nullptr) && (colonPos > greaterThanPos);
     }
 
-    bool validateKISSFrame(const String& kissFormattedFrame) {
-        return kissFormattedFrame.charAt(0) == (char)KissChar::FEND && kissFormattedFrame.charAt(kissFormattedFrame.length() - 1) == (char)KissChar::FEND;
+    bool validateTNC2Frame(const String& tnc2FormattedFrame) {
+        return validateTNC2Frame(tnc2FormattedFrame.c_str(), tnc2FormattedFrame.length());
     }
 
-    String decodeAddressAX25(const String& ax25Address, bool& isLastAddress, bool isRelay) {
-        String address = "";
-        for (int i = 0; i < 6; ++i) {
-            uint8_t currentCharacter = ax25Address.charAt(i);
-            currentCharacter >>= 1;
-            if (currentCharacter != ' ') address += (char)currentCharacter;
-        }
-        auto ssidChar           = (uint8_t)ax25Address.charAt(6);
-        bool hasBeenDigipited   = ssidChar & HAS_BEEN_DIGIPITED_MASK;
-        isLastAddress           = ssidChar & IS_LAST_ADDRESS_POSITION_MASK;
-        ssidChar >>= 1;
-
-        int ssid = 0b1111 & ssidChar;
-        if (ssid) {
-            address += '-';
-            address += ssid;
-        }
-        if (isRelay && hasBeenDigipited) address += '*';
-        return address;
-    }
+    struct KissWriter {
+        uint8_t*    buffer;
+        size_t      size;
+        size_t      length;
+        bool        overflow;
 
-    String decapsulateKISS(const String& frame) {
-        String ax25Frame = "";
-        for (int i = 2; i < frame.length() - 1; ++i) {
-            char currentChar = frame.charAt(i);
-            if (currentChar == (char)KissChar::FESC) {
-                char nextChar = frame.charAt(i + 1);
-                if (nextChar == (char)KissChar::TFEND) {
-                    ax25Frame += (char)KissChar::FEND;
-                } else if (nextChar == (char)KissChar::TFESC) {
-                    ax25Frame += (char)KissChar::FESC;
-                }
-                i++;
+        void putRaw(uint8_t byte) {
+            if (length < size) {
+                buffer[length++] = byte;
             } else {
-                ax25Frame += currentChar;
+                overflow = true;
             }
         }
-        return ax25Frame;
-    }
 
-    String encapsulateKISS(const String& ax25Frame, uint8_t command) {
-        String kissFrame = "";
-        kissFrame += (char)KissChar::FEND;
-        kissFrame += (char)(0x0f & command);
-
-        for (int i = 0; i < ax25Frame.length(); ++i) {
-            char currentChar = ax25Frame.charAt(i);
-            if (currentChar == (char)KissChar::FEND) {
-                kissFrame += (char)KissChar::FESC;
-                kissFrame += (char)KissChar::TFEND;
-            } else if (currentChar == (char)KissChar::FESC) {
-                kissFrame += (char)KissChar::FESC;
-                kissFrame += (char)KissChar::TFESC;
+        void put(uint8_t byte) {
+            if (byte == KissChar::FEND) {
+                putRaw(KissChar::FESC);
+                putRaw(KissChar::TFEND);
+            } else if (byte == KissChar::FESC) {
+                putRaw(KissChar::FESC);
+                putRaw(KissChar::TFESC);
             } else {
-                kissFrame += currentChar;
+                putRaw(byte);
+            }
+        }
+    };
+
+    int encodeAddressAX25(KissWriter& writer, const char* address, size_t length, bool isLastAddress) {
+        bool hasBeenDigipited = length > 0 && address[length - 1] == '*';
+        if (hasBeenDigipited) length--;
+
+        size_t callsignLength = 0;
+        while (callsignLength < length && address[callsignLength] != '-') callsignLength++;
+        if (callsignLength == 0 || callsignLength > 6) return KissErrorAddress;
+
+        int ssid = 0;
+        if (callsignLength < length) {                          // "-SSID"
+            size_t ssidLength = length - callsignLength - 1;
+            if (ssidLength == 0 || ssidLength > 2) return KissErrorAddress;
+            for (size_t i = callsignLength + 1; i < length; i++) {
+                if (address[i] < '0' || address[i] > '9') return KissErrorAddress;
+                ssid = ssid * 10 + (address[i] - '0');
             }
+            if (ssid > 15) return KissErrorAddress;
         }
-        kissFrame += (char)KissChar::FEND; // end of frame
-        return kissFrame;
+
+        for (size_t i = 0; i < 6; i++) {
+            char addressChar = (i < callsignLength) ? address[i] : ' ';
+            writer.put((uint8_t)(addressChar << 1));
+        }
+        uint8_t ssidChar = (ssid << 1) | 0b01100000;
+        if (hasBeenDigipited)   ssidChar |= HAS_BEEN_DIGIPITED_MASK;
+        if (isLastAddress)      ssidChar |= IS_LAST_ADDRESS_POSITION_MASK;
+        writer.put(ssidChar);
+        return 0;
     }
 
-    String encodeAddressAX25(String address) {
-        bool hasBeenDigipited = address.indexOf('*') != -1;
-        if (address.indexOf('-') == -1) {
-            if (hasBeenDigipited) address = address.substring(0, address.length() - 1);
-            address += "-0";
+    int encodeKISS(const char* tnc2Frame, size_t length, uint8_t* kissFrame, size_t kissFrameSize) {
+        const char* colonPos = (const char*)memchr(tnc2Frame, ':', length);
+        if (colonPos == nullptr) return KissErrorFrame;
+        const char* greaterThanPos = (const char*)memchr(tnc2Frame, '>', colonPos - tnc2Frame);
+        if (greaterThanPos == nullptr) return KissErrorFrame;
+
+        const char* digiStart[AX25_MAX_DIGIPEATERS];            // locate the path fields first: AX.25 wants DST before SRC
+        size_t      digiLength[AX25_MAX_DIGIPEATERS];
+        int         digiCount   = 0;
+        const char* destination = greaterThanPos + 1;
+        const char* fieldEnd    = destination;
+        while (fieldEnd < colonPos && *fieldEnd != ',') fieldEnd++;
+        size_t destinationLength = fieldEnd - destination;
+        while (fieldEnd < colonPos) {
+            const char* digi = fieldEnd + 1;
+            fieldEnd = digi;
+            while (fieldEnd < colonPos && *fieldEnd != ',') fieldEnd++;
+            if (digiCount == AX25_MAX_DIGIPEATERS) return KissErrorDigis;
+            digiStart[digiCount]    = digi;
+            digiLength[digiCount]   = fieldEnd - digi;
+            digiCount++;
         }
 
-        int separatorIndex  = address.indexOf('-');
-        int ssid            = address.substring(separatorIndex + 1).toInt();
-        String kissAddress  = "";
-        for (int i = 0; i < 6; ++i) {
-            char addressChar = ' ';
-            if (address.length() > i && i < separatorIndex) addressChar = address.charAt(i);
-            kissAddress += (char)(addressChar << 1);
+        KissWriter writer = {kissFrame, kissFrameSize, 0, false};
+        writer.putRaw(KissChar::FEND);
+        writer.putRaw(KissCmd::Data);
+
+        int state = encodeAddressAX25(writer, destination, destinationLength, false);
+        if (state == 0) state = encodeAddressAX25(writer, tnc2Frame, greaterThanPos - tnc2Frame, digiCount == 0);
+        for (int i = 0; i < digiCount && state == 0; i++) {
+            state = encodeAddressAX25(writer, digiStart[i], digiLength[i], i == digiCount - 1);
         }
-        kissAddress += (char)((ssid << 1) | 0b01100000 | (hasBeenDigipited ? HAS_BEEN_DIGIPITED_MASK : 0));
-        return kissAddress;
+        if (state != 0) return state;
+
+        writer.put(AX25Char::ControlField);
+        writer.put(AX25Char::InformationField);
+        for (const char* c = colonPos + 1; c < tnc2Frame + length; c++) writer.put((uint8_t)*c);
+        writer.putRaw(KissChar::FEND);
+        return writer.overflow ? KissErrorBuffer : (int)writer.length;
     }
 
-    String decodeKISS(const String& inputFrame, bool& dataFrame) {
-        String frame = "";
-        if (KISS_Utils::validateKISSFrame(inputFrame)) {
-            dataFrame = inputFrame.charAt(1) == KissCmd::Data;
-            if (dataFrame) {
-                String ax25Frame    = decapsulateKISS(inputFrame);
-                bool isLastAddress         = false;
-                String dstAddr      = decodeAddressAX25(ax25Frame.substring(0, 7), isLastAddress, false);
-                String srcAddr      = decodeAddressAX25(ax25Frame.substring(7, 14), isLastAddress, false);
-
-                frame = srcAddr + ">" + dstAddr;
-
-                int digiInfoIndex = 14;
-                while (!isLastAddress && digiInfoIndex + 7 < ax25Frame.length()) {
-                    String digiAddr = decodeAddressAX25(ax25Frame.substring(digiInfoIndex, digiInfoIndex + 7), isLastAddress, true);
-                    frame += ',' + digiAddr;
-                    digiInfoIndex += 7;
-                }
-                frame += ':';
-                frame += ax25Frame.substring(digiInfoIndex + 2);
-            } else {
-                frame += inputFrame;
-            }
+    int decodeAX25(const uint8_t* ax25Frame, size_t length, char* tnc2Frame, size_t tnc2FrameSize) {
+        if (length < 16) return KissErrorFrame;                 // 2 addresses + control + pid
+
+        size_t  addressCount    = 0;
+        bool    isLastAddress   = false;
+        while (!isLastAddress) {                                // find the address field end
+            if ((addressCount + 1) * 7 + 2 > length) return KissErrorFrame;
+            isLastAddress = ax25Frame[addressCount * 7 + 6] & IS_LAST_ADDRESS_POSITION_MASK;
+            addressCount++;
+            if (addressCount > AX25_MAX_DIGIPEATERS + 2) return KissErrorDigis;
         }
-        return frame;
-    }
+        if (addressCount < 2) return KissErrorFrame;
 
-    String encodeKISS(const String& frame) {
-        String ax25Frame = "";
-
-        if (KISS_Utils::validateTNC2Frame(frame)) {
-            int colonIndex = frame.indexOf(':');
-
-            String address = "";
-            bool destinationAddressWritten = false;
-            for (int i = 0; i <= colonIndex; i++) {
-                char currentChar = frame.charAt(i);
-                if (currentChar == ':' || currentChar == '>' || currentChar == ',') {
-                    if (!destinationAddressWritten && (currentChar == ',' || currentChar == ':')) {
-                        ax25Frame = encodeAddressAX25(address) + ax25Frame;
-                        destinationAddressWritten = true;
-                    } else {
-                        ax25Frame += encodeAddressAX25(address);
-                    }
-                    address = "";
-                } else {
-                    address += currentChar;
-                }
+        size_t outputLength = 0;
+        bool overflow = false;
+        auto putChar = [&](char c) {
+            if (outputLength + 1 < tnc2FrameSize) {
+                tnc2Frame[outputLength++] = c;
+            } else {
+                overflow = true;
+            }
+        };
+        auto putAddress = [&](const uint8_t* address, bool isRelay) {
+            for (int i = 0; i < 6; i++) {
+                char addressChar = (char)(address[i] >> 1);
+                if (addressChar != ' ') putChar(addressChar);
             }
-            auto lastAddressChar = (uint8_t)ax25Frame.charAt(ax25Frame.length() - 1);
-            ax25Frame.setCharAt(ax25Frame.length() - 1, (char)(lastAddressChar | IS_LAST_ADDRESS_POSITION_MASK));
-            ax25Frame += (char)AX25Char::ControlField;
-            ax25Frame += (char)AX25Char::InformationField;
-            ax25Frame += frame.substring(colonIndex + 1);
+            uint8_t ssid = (address[6] >> 1) & 0b1111;
+            if (ssid >= 10) {
+                putChar('-');
+                putChar('1');
+                putChar('0' + ssid - 10);
+            } else if (ssid > 0) {
+                putChar('-');
+                putChar('0' + ssid);
+            }
+            if (isRelay && (address[6] & HAS_BEEN_DIGIPITED_MASK)) putChar('*');
+        };
+
+        putAddress(ax25Frame + 7, false);                       // SRC>DST,DIGI...:
+        putChar('>');
+        putAddress(ax25Frame, false);
+        for (size_t i = 2; i < addressCount; i++) {
+            putChar(',');
+            putAddress(ax25Frame + i * 7, true);
         }
-        String kissFrame = encapsulateKISS(ax25Frame, KissCmd::Data);
-        return kissFrame;
+        putChar(':');
+        for (size_t i = addressCount * 7 + 2; i < length; i++) putChar((char)ax25Frame[i]);
+
+        if (tnc2FrameSize > 0) tnc2Frame[outputLength] = '\0';
+        return overflow ? KissErrorBuffer : (int)outputLength;
     }
 
-}
\ No newline at end of file
+}
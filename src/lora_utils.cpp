@@ -18,10 +18,14 @@
 
 #include <RadioLib.h>
 #include <logger.h>
+#include <atomic>
+#include <driver/gpio.h>
+#include <freertos/timers.h>
 #include <SPI.h>
 #include "notification_utils.h"
 #include "configuration.h"
 #include "board_pinout.h"
+#include "scheduler_utils.h"
 #include "lora_utils.h"
 #include "display.h"
 
@@ -31,8 +35,51 @@ extern LoraType         *currentLoRaType;
 extern uint8_t          loraIndex;
 extern int              loraIndexSize;
 
-bool operationDone   = true;
+#define RX_QUEUE_SIZE       8       // received packets waiting for loop()
+#define TX_DONE_TIMEOUT     15000   // ms, longer than any SF12 frame
+#define RADIO_TASK_STACK    4096
+#define RADIO_TASK_PRIORITY 3       // above loopTask (1)
+#if CONFIG_FREERTOS_UNICORE
+    #define RADIO_TASK_CORE 0
+#else
+    #define RADIO_TASK_CORE (ARDUINO_RUNNING_CORE == 0 ? 1 : 0)
+#endif
+#if defined(HAS_SX1278) || defined(HAS_SX1276)
+    #define RADIO_IRQ_PIN   RADIO_BUSY_PIN  // DIO0
+#else
+    #define RADIO_IRQ_PIN   RADIO_DIO1_PIN
+#endif
+
 bool transmitFlag    = true;
+bool scanIrqPending  = false;   // CAD done raises the same irq line as Rx done
+
+// PTT pre delay -> on air -> PTT post delay, advanced by updateTransmit() from the tx job
+enum TxState : uint8_t {
+    TX_IDLE,
+    TX_PTT_PRE,
+    TX_ON_AIR,
+    TX_PTT_POST
+};
+
+TxState                 txState         = TX_IDLE;
+char                    txFrame[LORA_FRAME_SIZE];
+size_t                  txFrameLength   = 0;
+TxDoneCallback          txDoneCallback  = nullptr;
+uint32_t                txStateTime     = 0;    // when the current state was entered
+uint32_t                txAirtime       = 0;
+bool                    txSuccess       = false;
+std::atomic<bool>       txDone(false);          // set by radioTask on the Tx done irq
+std::atomic<uint32_t>   txDoneTime(0);
+TimerHandle_t           txTimer         = NULL;
+
+TaskHandle_t        radioTaskHandle = NULL;
+SemaphoreHandle_t   radioMutex      = NULL;
+
+// single producer (radioTask) / single consumer (loop) ring
+LoRaFrame               rxQueue[RX_QUEUE_SIZE];
+std::atomic<uint8_t>    rxQueueHead(0);
+std::atomic<uint8_t>    rxQueueTail(0);
+LoRaRxStats             rxStats = {0, 0, 0};
 
 #if defined(HAS_SX1262)
     SX1262 radio = new Module(RADIO_CS_PIN, RADIO_DIO1_PIN, RADIO_RST_PIN, RADIO_BUSY_PIN);
@@ -57,8 +104,91 @@ bool transmitFlag    = true;
 
 namespace LoRa_Utils {
 
-    void setFlag(void) {
-        operationDone = true;
+    void IRAM_ATTR setFlag(void) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        if (radioTaskHandle != NULL) vTaskNotifyGiveFromISR(radioTaskHandle, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken == pdTRUE) portYIELD_FROM_ISR();
+    }
+
+    void txTimerExpired(TimerHandle_t timer) {     // PTT delay or Tx timeout over: run the tx job
+        SCHEDULER_Utils::signalEvent(EVENT_TX);
+    }
+
+    void lockRadio() {
+        if (radioMutex != NULL) xSemaphoreTake(radioMutex, portMAX_DELAY);
+    }
+
+    void unlockRadio() {
+        if (radioMutex != NULL) xSemaphoreGive(radioMutex);
+    }
+
+    int readFrame(LoRaFrame& frame) {
+        size_t length = radio.getPacketLength();
+        if (length > LORA_FRAME_SIZE - 1) length = LORA_FRAME_SIZE - 1;
+        int state = radio.readData((uint8_t*)frame.data, length);
+        if (state == RADIOLIB_ERR_NONE) {
+            frame.data[length]  = '\0';
+            frame.length        = length;
+            frame.rssi          = radio.getRSSI();
+            frame.snr           = radio.getSNR();
+            frame.freqError     = radio.getFrequencyError();
+        } else {
+            frame.length        = 0;
+        }
+        return state;
+    }
+
+    void readToQueue() {
+        uint8_t head = rxQueueHead.load(std::memory_order_relaxed);
+        uint8_t next = (head + 1) % RX_QUEUE_SIZE;
+        if (next == rxQueueTail.load(std::memory_order_acquire)) {
+            LoRaFrame discardedFrame;                   // still read it to clear the chip buffer
+            if (readFrame(discardedFrame) == RADIOLIB_ERR_NONE && discardedFrame.length > 0) {
+                rxStats.received++;
+                rxStats.overflowed++;
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "LoRa Rx", "Queue full, packet dropped (%u)", (unsigned int)rxStats.overflowed);
+            }
+            return;
+        }
+        int state = readFrame(rxQueue[head]);           // read straight into the free slot
+        if (state == RADIOLIB_ERR_NONE) {
+            if (rxQueue[head].length == 0) return;
+            rxStats.received++;
+            rxQueueHead.store(next, std::memory_order_release);
+            SCHEDULER_Utils::signalEvent(EVENT_RADIO_RX);
+        } else {
+            if (state == RADIOLIB_ERR_CRC_MISMATCH) rxStats.crcFailed++;
+            Serial.print(F("Rx failed, code "));   // 7 = CRC mismatch
+            Serial.println(state);
+        }
+    }
+
+    void radioTask(void *parameter) {
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            lockRadio();
+            if (scanIrqPending) {       // isChannelFree() already restarted Rx
+                scanIrqPending = false;
+                if (digitalRead(RADIO_IRQ_PIN) == LOW) {
+                    unlockRadio();
+                    continue;
+                }
+            }
+            if (transmitFlag) {         // Tx done irq: back to Rx
+                txDoneTime.store(millis());
+                radio.finishTransmit();
+                #if defined(TTGO_T_BEAM_1W)
+                    digitalWrite(RADIO_RXEN, HIGH);
+                #endif
+                radio.startReceive();
+                transmitFlag = false;
+                txDone.store(true, std::memory_order_release);
+                SCHEDULER_Utils::signalEvent(EVENT_TX);
+            } else {
+                readToQueue();
+            }
+            unlockRadio();
+        }
     }
 
     void changeFreq() {
@@ -69,6 +199,7 @@ namespace LoRa_Utils {
         }
         currentLoRaType = &Config.loraTypes[loraIndex];
 
+        lockRadio();
         float freq = (float)currentLoRaType->frequency/1000000;
         radio.setFrequency(freq);
         radio.setSpreadingFactor(currentLoRaType->spreadingFactor);
@@ -81,6 +212,7 @@ namespace LoRa_Utils {
         #if defined(HAS_SX1278) || defined(HAS_SX1276) || defined(HAS_1W_LORA)
             radio.setOutputPower(currentLoRaType->power);
         #endif
+        unlockRadio();
 
         String loraCountryFreq;
         switch (loraIndex) {
@@ -184,94 +316,208 @@ namespace LoRa_Utils {
             logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "LoRa", "Starting LoRa failed! State: %d", state);
             while (true);
         }
-    }
 
-    void sendNewPacket(const String& newPacket) {
-        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "LoRa Tx","---> %s", newPacket.c_str());
-        /*logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "LoRa","Send data: %s", newPacket.c_str());
-        logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "LoRa","Send data: %s", newPacket.c_str());
-        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "LoRa","Send data: %s", newPacket.c_str());*/
+        radioMutex = xSemaphoreCreateMutex();
+        txTimer = xTimerCreate("txTimer", 1, pdFALSE, NULL, txTimerExpired);
+        xTaskCreatePinnedToCore(radioTask, "radioTask", RADIO_TASK_STACK, NULL, RADIO_TASK_PRIORITY, &radioTaskHandle, RADIO_TASK_CORE);
+        #if defined(TTGO_T_BEAM_1W)
+            digitalWrite(RADIO_RXEN, HIGH);
+        #endif
+        lockRadio();
+        radio.startReceive();
+        transmitFlag = false;
+        unlockRadio();
+    }
 
-        if (Config.ptt.active) {
-            digitalWrite(Config.ptt.io_pin, Config.ptt.reverse ? LOW : HIGH);
-            delay(Config.ptt.preDelay);
+    void setTxState(TxState state, uint32_t wakeUpDelay) {
+        txState     = state;
+        txStateTime = millis();
+        if (wakeUpDelay > 0 && txTimer != NULL) {
+            xTimerChangePeriod(txTimer, max(pdMS_TO_TICKS(wakeUpDelay), (TickType_t)1), 0);
         }
-        if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, HIGH);
-        if (Config.notification.buzzerActive && Config.notification.txBeep) NOTIFICATION_Utils::beaconTxBeep();
+    }
 
+    void startRadioTransmit() {
+        lockRadio();
         #if defined(TTGO_T_BEAM_1W)
             digitalWrite(RADIO_RXEN, LOW);
         #endif
-        int state = radio.transmit("\x3c\xff\x01" + newPacket);
+        txDone.store(false);
         transmitFlag = true;
+        uint32_t startTime = millis();
+        int state = radio.startTransmit((uint8_t*)txFrame, txFrameLength);
+        if (state != RADIOLIB_ERR_NONE) {
+            transmitFlag = false;
+            #if defined(TTGO_T_BEAM_1W)
+                digitalWrite(RADIO_RXEN, HIGH);
+            #endif
+            radio.startReceive();
+        }
+        unlockRadio();
+
         if (state == RADIOLIB_ERR_NONE) {
-            //Serial.println(F("success!"));
+            setTxState(TX_ON_AIR, TX_DONE_TIMEOUT);
+            txStateTime = startTime;
         } else {
             Serial.print(F("Tx failed, code "));
             Serial.println(state);
+            txSuccess = false;
+            txAirtime = 0;
+            if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, LOW);
+            setTxState(TX_PTT_POST, Config.ptt.active ? Config.ptt.postDelay : 0);
         }
+    }
+
+    bool startTransmit(const StringView& newPacket, TxDoneCallback callback) {
+        if (txState != TX_IDLE) return false;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "LoRa Tx","---> %.*s", (int)newPacket.length, newPacket.data);
+
+        memcpy(txFrame, "\x3c\xff\x01", 3);
+        txFrameLength = min(newPacket.length, (size_t)(LORA_FRAME_SIZE - 4));
+        memcpy(txFrame + 3, newPacket.data, txFrameLength);
+        txFrameLength += 3;
+        txDoneCallback = callback;
 
-        if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, LOW);
+        if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, HIGH);
+        if (Config.notification.buzzerActive && Config.notification.txBeep) NOTIFICATION_Utils::beaconTxBeep();
         if (Config.ptt.active) {
-            delay(Config.ptt.postDelay);
-            digitalWrite(Config.ptt.io_pin, Config.ptt.reverse ? HIGH : LOW);
+            digitalWrite(Config.ptt.io_pin, Config.ptt.reverse ? LOW : HIGH);
+            if (Config.ptt.preDelay > 0) {
+                setTxState(TX_PTT_PRE, Config.ptt.preDelay);
+                return true;
+            }
+        }
+        startRadioTransmit();
+        return true;
+    }
+
+    void updateTransmit() {
+        uint32_t inState = millis() - txStateTime;
+        switch (txState) {
+            case TX_PTT_PRE:
+                if (inState >= (uint32_t)Config.ptt.preDelay) startRadioTransmit();
+                break;
+            case TX_ON_AIR:
+                if (txDone.load(std::memory_order_acquire)) {
+                    txSuccess = true;
+                    txAirtime = txDoneTime.load() - txStateTime;
+                } else if (inState >= TX_DONE_TIMEOUT) {    // missed irq: recover Rx
+                    lockRadio();
+                    radio.finishTransmit();
+                    #if defined(TTGO_T_BEAM_1W)
+                        digitalWrite(RADIO_RXEN, HIGH);
+                    #endif
+                    radio.startReceive();
+                    transmitFlag = false;
+                    unlockRadio();
+                    logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "LoRa Tx", "Tx done irq missing");
+                    txSuccess = false;
+                    txAirtime = inState;
+                } else {
+                    break;
+                }
+                if (Config.notification.ledTx) digitalWrite(Config.notification.ledTxPin, LOW);
+                setTxState(TX_PTT_POST, Config.ptt.active ? Config.ptt.postDelay : 0);
+                if (Config.ptt.active && Config.ptt.postDelay > 0) break;
+                // fall through
+            case TX_PTT_POST:
+                if (Config.ptt.active) {
+                    if (millis() - txStateTime < (uint32_t)Config.ptt.postDelay) break;
+                    digitalWrite(Config.ptt.io_pin, Config.ptt.reverse ? HIGH : LOW);
+                }
+                txState = TX_IDLE;
+                if (txDoneCallback != nullptr) txDoneCallback(txAirtime, txSuccess);
+                break;
+            default:
+                break;
+        }
+    }
+
+    bool isTransmitting() {
+        return txState != TX_IDLE;
+    }
+
+    void sendNewPacket(const StringView& newPacket) {  // blocking, for shutdown
+        while (isTransmitting()) {
+            updateTransmit();
+            delay(1);
+        }
+        startTransmit(newPacket, nullptr);
+        while (isTransmitting()) {
+            updateTransmit();
+            delay(1);
         }
     }
 
+    bool isChannelFree() {      // LoRa CAD, interrupts Rx for a few symbols
+        lockRadio();
+        scanIrqPending = true;
+        int state = radio.scanChannel();
+        radio.startReceive();
+        unlockRadio();
+        return state != RADIOLIB_LORA_DETECTED && state != RADIOLIB_PREAMBLE_DETECTED;
+    }
+
     void wakeRadio() {
+        lockRadio();
         radio.startReceive();
+        unlockRadio();
     }
 
-    ReceivedLoRaPacket receiveFromSleep() {
-        ReceivedLoRaPacket receivedLoraPacket;
-        String packet = "";
+    bool receiveFromSleep(LoRaFrame& receivedFrame) {
+        lockRadio();
         #if defined(TTGO_T_BEAM_1W)
             digitalWrite(RADIO_RXEN, HIGH);
         #endif
-        int state = radio.readData(packet);
-        if (state == RADIOLIB_ERR_NONE) {
-            receivedLoraPacket.text       = packet;
-            receivedLoraPacket.rssi       = radio.getRSSI();
-            receivedLoraPacket.snr        = radio.getSNR();
-            receivedLoraPacket.freqError  = radio.getFrequencyError();
-        } else {
-            //
-        }
-        return receivedLoraPacket;
+        int state = readFrame(receivedFrame);
+        unlockRadio();
+        return state == RADIOLIB_ERR_NONE && receivedFrame.length > 0;
     }
 
-    ReceivedLoRaPacket receivePacket() {
-        ReceivedLoRaPacket receivedLoraPacket;
-        String packet = "";
-        if (operationDone) {
-            operationDone = false;
-            if (transmitFlag) {
-                #if defined(TTGO_T_BEAM_1W)
-                    digitalWrite(RADIO_RXEN, HIGH);
-                #endif
-                radio.startReceive();
-                transmitFlag = false;
-            } else {
-                int state = radio.readData(packet);
-                if (state == RADIOLIB_ERR_NONE) {
-                    if(!packet.isEmpty()) {
-                        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "LoRa Rx","---> %s", packet.substring(3).c_str());
-                        receivedLoraPacket.text       = packet;
-                        receivedLoraPacket.rssi       = radio.getRSSI();
-                        receivedLoraPacket.snr        = radio.getSNR();
-                        receivedLoraPacket.freqError  = radio.getFrequencyError();
-                    }
-                } else {
-                    Serial.print(F("Rx failed, code "));   // 7 = CRC mismatch
-                    Serial.println(state);
-                }
-            }
+    bool receivePacket(LoRaFrame& receivedFrame) {
+        uint8_t tail = rxQueueTail.load(std::memory_order_relaxed);
+        if (tail == rxQueueHead.load(std::memory_order_acquire)) return false;
+        const LoRaFrame& queuedFrame = rxQueue[tail];
+        memcpy(receivedFrame.data, queuedFrame.data, queuedFrame.length + 1);
+        receivedFrame.length    = queuedFrame.length;
+        receivedFrame.rssi      = queuedFrame.rssi;
+        receivedFrame.snr       = queuedFrame.snr;
+        receivedFrame.freqError = queuedFrame.freqError;
+        rxQueueTail.store((tail + 1) % RX_QUEUE_SIZE, std::memory_order_release);
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "LoRa Rx","---> %s", receivedFrame.payload().data);
+        return true;
+    }
+
+    LoRaRxStats getRxStats() {
+        return rxStats;
+    }
+
+    bool prepareForLightSleep() {   // keeps the radio locked until resumeFromLightSleep()
+        if (txState != TX_IDLE) return false;   // PTT / Tx done timing must not be stretched
+        if (radioMutex == NULL || xSemaphoreTake(radioMutex, 0) != pdTRUE) return false;
+        if (transmitFlag) {             // still waiting for Tx done
+            xSemaphoreGive(radioMutex);
+            return false;
         }
-        return receivedLoraPacket;
+        gpio_intr_disable((gpio_num_t)RADIO_IRQ_PIN);   // level wakeup would retrigger the edge isr
+        gpio_wakeup_enable((gpio_num_t)RADIO_IRQ_PIN, GPIO_INTR_HIGH_LEVEL);
+        return true;
+    }
+
+    bool resumeFromLightSleep() {
+        gpio_wakeup_disable((gpio_num_t)RADIO_IRQ_PIN);
+        gpio_set_intr_type((gpio_num_t)RADIO_IRQ_PIN, GPIO_INTR_POSEDGE);
+        gpio_intr_enable((gpio_num_t)RADIO_IRQ_PIN);
+        bool irqPending = digitalRead(RADIO_IRQ_PIN) == HIGH;
+        xSemaphoreGive(radioMutex);
+        if (irqPending && radioTaskHandle != NULL) xTaskNotifyGive(radioTaskHandle);    // edge happened while asleep
+        return irqPending;
     }
 
     void sleepRadio() {
+        lockRadio();
         radio.sleep();
+        unlockRadio();
     }
 
 }
\ No newline at end of file
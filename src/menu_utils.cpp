@@ -20,6 +20,7 @@
 #include <TinyGPS++.h>
 #include <vector>
 #include "notification_utils.h"
+#include "airtime_utils.h"
 #include "custom_characters.h"
 #include "station_utils.h"
 #include "configuration.h"
@@ -38,8 +39,6 @@ extern int                  menuDisplay;
 extern Beacon               *currentBeacon;
 extern Configuration        Config;
 extern TinyGPSPlus          gps;
-extern std::vector<String>  loadedAPRSMessages;
-extern std::vector<String>  loadedWLNKMails;
 extern int                  messagesIterator;
 extern uint8_t              loraIndex;
 extern uint32_t             menuTime;
@@ -122,6 +121,7 @@ namespace MENU_Utils {
     }
 
     void showOnScreen() {
+        if (displayOverlayActive()) return;     // a timed message is still on screen
         String lastLine;
         uint32_t lastMenuTime = millis() - menuTime;
         if (!(menuDisplay==0) && !(menuDisplay==400) && !(menuDisplay==410) && !(menuDisplay==300) && !(menuDisplay>=500 && menuDisplay<=5100) && lastMenuTime > 30*1000) {
@@ -186,8 +186,9 @@ namespace MENU_Utils {
                 break;
             case 100:   // 1.Messages ---> Messages Read ---> Display Received/Saved APRS Messages
                 {
-                    String msgSender    = loadedAPRSMessages[messagesIterator].substring(0, loadedAPRSMessages[messagesIterator].indexOf(","));
-                    String msgText      = loadedAPRSMessages[messagesIterator].substring(loadedAPRSMessages[messagesIterator].indexOf(",") + 1);
+                    String savedMessage = MSG_Utils::getSavedMessage(0, messagesIterator);
+                    String msgSender    = savedMessage.substring(0, savedMessage.indexOf(","));
+                    String msgText      = savedMessage.substring(savedMessage.indexOf(",") + 1);
 
                     #ifdef HAS_TFT
                         #if defined(HELTEC_WIRELESS_TRACKER)
@@ -456,10 +457,13 @@ namespace MENU_Utils {
 
 //////////
             case 40:    //4.Stations ---> Packet Decoder
-                displayShow(" STATIONS>", "", "> Packet Decoder", "  Near By Stations", "", "<Back");
+                displayShow(" STATIONS>", "", "> Packet Decoder", "  Near By Stations", "  Airtime", "<Back");
                 break;
             case 41:    //4.Stations ---> Near By Stations
-                displayShow(" STATIONS>", "", "  Packet Decoder", "> Near By Stations", "", "<Back");
+                displayShow(" STATIONS>", "", "  Packet Decoder", "> Near By Stations", "  Airtime", "<Back");
+                break;
+            case 42:    //4.Stations ---> Airtime
+                displayShow(" STATIONS>", "", "  Packet Decoder", "  Near By Stations", "> Airtime", "<Back");
                 break;
 
             case 400:   //4.Stations ---> Packet Decoder
@@ -497,6 +501,18 @@ namespace MENU_Utils {
             case 410:    //4.Stations ---> Near By Stations
                 displayShow(" NEAR BY>", STATION_Utils::getNearStation(0), STATION_Utils::getNearStation(1), STATION_Utils::getNearStation(2), STATION_Utils::getNearStation(3), "<Back");
                 break;
+            case 420:   //4.Stations ---> Airtime
+                {
+                    AirtimeUsage usage = AIRTIME_Utils::getUsage(loraIndex);
+                    char limitLine[24], minuteLine[24], tenMinutesLine[24], hourLine[24], loadLine[24];
+                    snprintf(limitLine, sizeof(limitLine), "Limit:%.1f%% Pkts:%u", usage.limit / 10.0, (unsigned int)usage.packets);
+                    snprintf(minuteLine, sizeof(minuteLine), "1 min :%6.1fs %5.1f%%", usage.lastMinute / 1000.0, usage.lastMinute / 600.0);
+                    snprintf(tenMinutesLine, sizeof(tenMinutesLine), "10 min:%6.1fs %5.1f%%", usage.last10Minutes / 1000.0, usage.last10Minutes / 6000.0);
+                    snprintf(hourLine, sizeof(hourLine), "1 hour:%6.1fs %5.1f%%", usage.lastHour / 1000.0, usage.lastHour / 36000.0);
+                    snprintf(loadLine, sizeof(loadLine), "<Back    Load:%3u%%", (unsigned int)usage.load);
+                    displayShow(" AIRTIME>", limitLine, minuteLine, tenMinutesLine, hourLine, loadLine);
+                }
+                break;
 
 //////////
             case 50:    // 5.Winlink MENU
@@ -538,7 +554,7 @@ namespace MENU_Utils {
                 break;
             case 50101:    // WINLINK: Downloaded Mails //
                 {
-                    String mailText = loadedWLNKMails[messagesIterator];
+                    String mailText = MSG_Utils::getSavedMessage(1, messagesIterator);
 
                     #ifdef HAS_TFT
                         #if defined(HELTEC_WIRELESS_TRACKER)
@@ -817,7 +833,7 @@ namespace MENU_Utils {
                 }
 
                 if (showHumanHeading) {
-                    fifthRowMainMenu = GPS_Utils::getCardinalDirection(gps.course.deg());
+                    fifthRowMainMenu = GPS_Utils::getCardinalDirection(GPS_Utils::getBearing(gps.course.deg()));
                 } else {
                     fifthRowMainMenu = "LAST Rx = ";
                     fifthRowMainMenu += MSG_Utils::getLastHeardTracker();
@@ -18,14 +18,17 @@
 
 #include <APRSPacketLib.h>
 #include <TinyGPS++.h>
-#include <SPIFFS.h>
 #include "notification_utils.h"
 #include "bluetooth_utils.h"
 #include "winlink_utils.h"
 #include "configuration.h"
 #include "board_pinout.h"
+#include "airtime_utils.h"
 #include "lora_utils.h"
+#include "tx_utils.h"
 #include "ble_utils.h"
+#include "packetlog_utils.h"
+#include "msgstore_utils.h"
 #include "msg_utils.h"
 #include "gps_utils.h"
 #include "display.h"
@@ -56,6 +59,8 @@ extern uint32_t             wxRequestTime;
 
 extern APRSPacket           lastReceivedPacket;
 
+extern OutgoingMessage      messagePool[MSG_POOL_SIZE];
+
 extern bool                 SleepModeActive;
 
 String  lastMessageSaved        = "";
@@ -65,18 +70,14 @@ bool    noAPRSMsgWarning        = false;
 bool    noWLNKMsgWarning        = false;
 String  lastHeardTracker        = "NONE";
 
-std::vector<String>             loadedAPRSMessages;
-std::vector<String>             loadedWLNKMails;
-std::vector<String>             outputMessagesBuffer;
-std::vector<String>             outputAckRequestBuffer;
-std::vector<Packet15SegBuffer>  packet15SegBuffer;
+MessageStore                    aprsMessageStore    = {"/aprsMessages.dat", MSGSTORE_APRS_CAPACITY};
+MessageStore                    winlinkMailStore    = {"/winlinkMails.dat", MSGSTORE_WLNK_CAPACITY};
 
 int         ackRequestNumber    = random(1,999);
-bool        ackRequestState     = false;
-String      ackCallsignRequest  = "";
-String      ackNumberRequest    = "";
+String      winlinkAckNumber    = "";
 uint32_t    lastMsgRxTime       = millis();
-uint32_t    lastRetryTime       = millis();
+
+const uint16_t retryDelays[MSG_ACK_TRIES] = {30, 60, 120, 120, 120, 30};    // s after each try, the last one before giving up
 
 bool        messageLed          = false;
 uint32_t    messageLedTime      = millis();
@@ -105,93 +106,30 @@ namespace MSG_Utils {
     }
 
     void loadNumMessages() {
-        if(!SPIFFS.begin(true)) {
-            Serial.println("An Error has occurred while mounting SPIFFS");
-            return;
-        }
-
-        File fileToReadAPRS = SPIFFS.open("/aprsMessages.txt");
-        if(!fileToReadAPRS) {
-            Serial.println("Failed to open APRS_Msg for reading");
-            return;
-        }
-
-        std::vector<String> v1;
-        while (fileToReadAPRS.available()) {
-            v1.push_back(fileToReadAPRS.readStringUntil('\n'));
-        }
-        fileToReadAPRS.close();
-
-        numAPRSMessages = 0;
-        for (String s1 : v1) {
-            numAPRSMessages++;
-        }
-        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Number of APRS Messages : %s", String(numAPRSMessages));
-
-        File fileToReadWLNK = SPIFFS.open("/winlinkMails.txt");
-        if(!fileToReadWLNK) {
-            Serial.println("Failed to open Winlink_Msg for reading");
-            return;
-        }
-
-        std::vector<String> v2;
-        while (fileToReadWLNK.available()) {
-            v2.push_back(fileToReadWLNK.readStringUntil('\n'));
-        }
-        fileToReadWLNK.close();
-
-        numWLNKMessages = 0;
-        for (String s2 : v2) {
-            numWLNKMessages++;
-        }
-        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Number of Winlink Mails : %s", String(numWLNKMessages));
+        if (!aprsMessageStore.file) MSGSTORE_Utils::open(aprsMessageStore, "/aprsMessages.txt");
+        if (!winlinkMailStore.file) MSGSTORE_Utils::open(winlinkMailStore, "/winlinkMails.txt");
+        numAPRSMessages = MSGSTORE_Utils::count(aprsMessageStore);
+        numWLNKMessages = MSGSTORE_Utils::count(winlinkMailStore);
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Number of APRS Messages : %d", numAPRSMessages);
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "Number of Winlink Mails : %d", numWLNKMessages);
     }
 
-    void loadMessagesFromMemory(uint8_t typeOfMessage) {
-        File fileToRead;
+    void loadMessagesFromMemory(uint8_t typeOfMessage) {    // messages are read one page at a time by the menu
         if (typeOfMessage == 0) {  // APRS
-            noAPRSMsgWarning = false;
-            if (numAPRSMessages == 0) {
-                noAPRSMsgWarning = true;
-            } else {
-                loadedAPRSMessages.clear();
-                fileToRead = SPIFFS.open("/aprsMessages.txt");
-            }
-            if (noAPRSMsgWarning) {
-                displayShow("   INFO", "", " NO APRS MSG SAVED", 1500);
-            } else {
-                if(!fileToRead) {
-                    Serial.println("Failed to open file for reading");
-                    return;
-                }
-                while (fileToRead.available()) {
-                    loadedAPRSMessages.push_back(fileToRead.readStringUntil('\n'));
-                }
-                fileToRead.close();
-            }
+            noAPRSMsgWarning = numAPRSMessages == 0;
+            if (noAPRSMsgWarning) displayShow("   INFO", "", " NO APRS MSG SAVED", 1500);
         } else if (typeOfMessage == 1) { // WLNK
-            noWLNKMsgWarning = false;
-            if (numWLNKMessages == 0) {
-                noWLNKMsgWarning = true;
-            } else {
-                loadedWLNKMails.clear();
-                fileToRead = SPIFFS.open("/winlinkMails.txt");
-            }
-            if (noWLNKMsgWarning) {
-                displayShow("   INFO", "", " NO WLNK MAILS SAVED", 1500);
-            } else {
-                if(!fileToRead) {
-                    Serial.println("Failed to open file for reading");
-                    return;
-                }
-                while (fileToRead.available()) {
-                    loadedWLNKMails.push_back(fileToRead.readStringUntil('\n'));
-                }
-                fileToRead.close();
-            }
+            noWLNKMsgWarning = numWLNKMessages == 0;
+            if (noWLNKMsgWarning) displayShow("   INFO", "", " NO WLNK MAILS SAVED", 1500);
         }
     }
 
+    String getSavedMessage(uint8_t typeOfMessage, int index) {
+        String text;
+        MSGSTORE_Utils::read((typeOfMessage == 0) ? aprsMessageStore : winlinkMailStore, index, text);
+        return text;
+    }
+
     void ledNotification() {
         uint32_t currentTime = millis();
         uint32_t ledTimeDelta = currentTime - messageLedTime;
@@ -208,14 +146,10 @@ namespace MSG_Utils {
     }
 
     void deleteFile(uint8_t typeOfFile) {
-        if(!SPIFFS.begin(true)) {
-            Serial.println("An Error has occurred while mounting SPIFFS");
-            return;
-        }
         if (typeOfFile == 0) {  //APRS
-            SPIFFS.remove("/aprsMessages.txt");
+            MSGSTORE_Utils::clear(aprsMessageStore);
         } else if (typeOfFile == 1) {   //WLNK
-            SPIFFS.remove("/winlinkMails.txt");
+            MSGSTORE_Utils::clear(winlinkMailStore);
         }
         if (Config.notification.ledMessage) messageLed = false;
     }
@@ -223,34 +157,18 @@ namespace MSG_Utils {
     void saveNewMessage(uint8_t typeMessage, const String& station, const String& newMessage) {
         String message = newMessage;
         if (typeMessage == 0 && lastMessageSaved != message) {   //APRS
-            File fileToAppendAPRS = SPIFFS.open("/aprsMessages.txt", FILE_APPEND);
-            if(!fileToAppendAPRS) {
-                Serial.println("There was an error opening the file for appending");
-                return;
-            }
             message.trim();
-            if(!fileToAppendAPRS.println(station + "," + message)) {
-                Serial.println("File append failed");
-            }
+            if (!MSGSTORE_Utils::append(aprsMessageStore, station + "," + message)) return;
             lastMessageSaved = message;
-            numAPRSMessages++;
-            fileToAppendAPRS.close();
+            numAPRSMessages = MSGSTORE_Utils::count(aprsMessageStore);
             if (Config.notification.ledMessage) {
                 messageLed = true;
             }
         } else if (typeMessage == 1 && lastMessageSaved != message) {    //WLNK
-            File fileToAppendWLNK = SPIFFS.open("/winlinkMails.txt", FILE_APPEND);
-            if(!fileToAppendWLNK) {
-                Serial.println("There was an error opening the file for appending");
-                return;
-            }
             message.trim();
-            if(!fileToAppendWLNK.println(message)) {
-                Serial.println("File append failed");
-            }
+            if (!MSGSTORE_Utils::append(winlinkMailStore, message)) return;
             lastMessageSaved = message;
-            numWLNKMessages++;
-            fileToAppendWLNK.close();
+            numWLNKMessages = MSGSTORE_Utils::count(winlinkMailStore);
             if (Config.notification.ledMessage) {
                 messageLed = true;
             }
@@ -268,283 +186,255 @@ namespace MSG_Utils {
         } else {
             displayShow((station == "WLNK-1") ? "WINLINK Tx" : " MSG Tx >", "", newPacket, 100);
         }
-        LoRa_Utils::sendNewPacket(newPacket);
+        TX_Utils::queuePacket(newPacket, (textMessage.indexOf("ack") == 0) ? TX_PRIORITY_ACK : TX_PRIORITY_MESSAGE);
     }
 
-    String getAckRequestNumber() {
+    uint16_t getAckRequestNumber() {
         ackRequestNumber++;
         if (ackRequestNumber > 999) {
             ackRequestNumber = 1;
         }
-        return String(ackRequestNumber);
+        return ackRequestNumber;
+    }
+
+    void transmitMessage(OutgoingMessage& message) {
+        if (message.msgNumber == 0) {
+            sendMessage(message.addressee, message.text);
+        } else {
+            char number[6];
+            snprintf(number, sizeof(number), "%u", message.msgNumber);
+            if (strcmp(message.addressee, "WLNK-1") == 0) winlinkAckNumber = number;
+            sendMessage(message.addressee, String(message.text) + "{" + number);
+        }
+        message.tries++;
+        lastTxTime = millis();
+    }
+
+    void setup() {
+        MSGBUFFER_Utils::setup(millis());
     }
 
     void addToOutputBuffer(uint8_t typeOfMessage, const String& station, const String& textMessage) {
-        bool alreadyInBuffer;
-        if (typeOfMessage == 1) {
-            alreadyInBuffer = false;
-            if (!outputMessagesBuffer.empty()) {
-                for (int i = 0; i < outputMessagesBuffer.size(); i++) {
-                    if (outputMessagesBuffer[i].indexOf(station + "," + textMessage) == 0) {
-                        alreadyInBuffer = true;
-                        break;
-                    }
-                }
-            }
-            if (!outputAckRequestBuffer.empty()) {
-                for (int j = 0; j < outputAckRequestBuffer.size(); j++) {
-                    if (outputAckRequestBuffer[j].indexOf(station + "," + textMessage) > 1) {
-                        alreadyInBuffer = true;
-                        break;
-                    }
-                }
-            }
-            if (!alreadyInBuffer) {
-                outputMessagesBuffer.push_back(station + "," + textMessage + "{" + getAckRequestNumber());
-            }
-        } else if (typeOfMessage == 0) {
-            alreadyInBuffer = false;
-            if (!outputMessagesBuffer.empty()) {
-                for (int k = 0; k < outputMessagesBuffer.size(); k++) {
-                    if (outputMessagesBuffer[k].indexOf(station + "," + textMessage) == 0) {
-                        alreadyInBuffer = true;
-                        break;
-                    }
-                }
-            }
-            if (!alreadyInBuffer) {
-                outputMessagesBuffer.push_back(station + "," + textMessage);
-            }
+        int8_t slot = MSGBUFFER_Utils::addMessage(station.c_str(), textMessage.c_str());
+        if (slot == MSG_ALREADY_QUEUED) return;     // already queued or waiting for its ack
+        if (slot == MSG_POOL_FULL) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Msg", "Output buffer full, message to %s dropped", station.c_str());
+            return;
         }
+        if (textMessage.length() > MSG_TEXT_SIZE) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Msg", "Message to %s truncated", station.c_str());
+        }
+
+        if (typeOfMessage == 1) messagePool[slot].msgNumber = getAckRequestNumber();
     }
 
-    void processOutputBuffer() {
-        if (!outputMessagesBuffer.empty() && (millis() - lastMsgRxTime) >= 6000 && (millis() - lastTxTime) > 3000) {
-            String addressee = outputMessagesBuffer[0].substring(0, outputMessagesBuffer[0].indexOf(","));
-            String message = outputMessagesBuffer[0].substring(outputMessagesBuffer[0].indexOf(",") + 1);
-            if (message.indexOf("{") > 0) {     // message with ack Request
-                outputAckRequestBuffer.push_back("6," + addressee + "," + message);  // 6 is for ack packets retries
-                outputMessagesBuffer.erase(outputMessagesBuffer.begin());
-            } else {                            // message without ack Request
-                sendMessage(addressee, message);
-                outputMessagesBuffer.erase(outputMessagesBuffer.begin());
-                lastTxTime = millis();
+    // A message waiting for its ack is sent again whenever its retry falls due on the wheel,
+    // so every addressee retries on its own schedule and an unanswered one delays nobody else.
+    void processRetry(int8_t index, uint32_t now) {
+        OutgoingMessage& message = messagePool[index];
+        if (message.tries >= MSG_ACK_TRIES) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Msg", "No ack from %s for %u", message.addressee, (unsigned int)message.msgNumber);
+            MSGBUFFER_Utils::expireMessage(index);
+            if (strcmp(message.addressee, "WLNK-1") == 0 && winlinkStatus > 0 && winlinkStatus < 5) {   // if not complete Winlink Challenge Process it will reset Login process
+                winlinkStatus = 0;
             }
+        } else if ((now - lastMsgRxTime) < 4500 || (now - lastTxTime) <= 3000) {
+            MSGBUFFER_Utils::scheduleRetry(index, now + MSG_WHEEL_TICK);
+        } else {
+            transmitMessage(message);
+            MSGBUFFER_Utils::scheduleRetry(index, now + retryDelays[message.tries - 1] * 1000UL);
         }
-        if (outputAckRequestBuffer.empty()) {
-            ackRequestState = false;
-        } else if (!outputAckRequestBuffer.empty() && (millis() - lastMsgRxTime) >= 4500 && (millis() - lastTxTime) > 3000) {
-            bool sendRetry = false;
-            String triesLeft = outputAckRequestBuffer[0].substring(0 , outputAckRequestBuffer[0].indexOf(","));
-            switch (triesLeft.toInt()) {
-                case 6:
-                    sendRetry = true;
-                    ackRequestState = true;
-                    break;
-                case 5:
-                    if (millis() - lastRetryTime > 30 * 1000) sendRetry = true;
-                    break;
-                case 4:
-                    if (millis() - lastRetryTime > 60 * 1000) sendRetry = true;
-                    break;
-                case 3:
-                    if (millis() - lastRetryTime > 120 * 1000) sendRetry = true;
-                    break;
-                case 2:
-                    if (millis() - lastRetryTime > 120 * 1000) sendRetry = true;
-                    break;
-                case 1:
-                    if (millis() - lastRetryTime > 120 * 1000) sendRetry = true;
-                    break;
-                case 0:
-                    if (millis() - lastRetryTime > 30 * 1000) {
-                        ackRequestNumber = false;
-                        outputAckRequestBuffer.erase(outputAckRequestBuffer.begin());
-                        if (winlinkStatus > 0 && winlinkStatus < 5) {   // if not complete Winlink Challenge Process it will reset Login process
-                            winlinkStatus = 0;
-                        }
-                    }
-                    break;
-            }
-            if (sendRetry) {
-                String rest = outputAckRequestBuffer[0].substring(outputAckRequestBuffer[0].indexOf(",") + 1);
-                ackCallsignRequest = rest.substring(0, rest.indexOf(","));
-                String payload = rest.substring(rest.indexOf(",") + 1);
-                ackNumberRequest = payload.substring(payload.indexOf("{") + 1);
-                sendMessage(ackCallsignRequest, payload);
-                lastTxTime = millis();
-                lastRetryTime = millis();
-                outputAckRequestBuffer[0] = String(triesLeft.toInt() - 1) + "," + ackCallsignRequest + "," + payload;
-            }
+    }
+
+    void processOutputBuffer() {
+        uint32_t now = millis();
+        MSGBUFFER_Utils::processWheel(now, processRetry);
+
+        if ((now - lastMsgRxTime) < 6000 || (now - lastTxTime) <= 3000) return;
+        int8_t next = MSGBUFFER_Utils::nextPending();
+        if (next == -1) return;
+
+        OutgoingMessage& message = messagePool[next];
+        transmitMessage(message);
+        if (message.msgNumber == 0) {
+            message.state = MSG_STATE_FREE;
+        } else {
+            MSGBUFFER_Utils::waitForAck(next, now + retryDelays[0] * 1000UL);
         }
     }
 
+    void processAck(const String& station, const String& ackNumber) {
+        MSGBUFFER_Utils::processAck(station.c_str(), ackNumber.toInt());
+    }
+
     void cleanOutputAckRequestBuffer(const String& station) {
-        if (!outputAckRequestBuffer.empty()) {
-            for (int i = outputAckRequestBuffer.size() - 1; i >= 0; i--) {
-                if (outputAckRequestBuffer[i].indexOf(station) == 0) outputAckRequestBuffer.erase(outputAckRequestBuffer.begin() + i);
+        MSGBUFFER_Utils::releaseMessages(station.c_str());
+    }
+
+    bool handleWeatherReply(PayloadKeyword keyword) {
+        if (keyword != KEYWORD_WX) return false;
+        Serial.println("Weather Report Received");
+
+        // "WX place,summary, 12.3P1013H80W2.5,x,270"
+        char place[32], summary[32], temperature[8], pressure[8], humidity[8], windSpeed[8], windDegrees[8];
+        PayloadTokenizer tokens(lastReceivedPacket.payload);
+        tokens.skip(2);
+        if (tokens.cursor < tokens.end && *tokens.cursor == ' ') tokens.skip(1);
+        tokens.next(',', place, sizeof(place));
+        tokens.next(',', summary, sizeof(summary));
+        tokens.skip(1);
+        tokens.next('P', temperature, sizeof(temperature));
+        tokens.next('H', pressure, sizeof(pressure));
+        tokens.next('W', humidity, sizeof(humidity));
+        tokens.next(',', windSpeed, sizeof(windSpeed));
+        tokens.skipPast(',');
+        tokens.next('\n', windDegrees, sizeof(windDegrees));
+
+        char fifthLineWR[32], sixthLineWR[32];
+        snprintf(fifthLineWR, sizeof(fifthLineWR), "%sC  %shPa  %s%%", temperature, pressure, humidity);
+        snprintf(sixthLineWR, sizeof(sixthLineWR), "(wind %sm/s %sdeg)", windSpeed, windDegrees);
+
+        displayShow("<WEATHER>", "From --> " + lastReceivedPacket.sender, place, summary, fifthLineWR, sixthLineWR);
+        menuDisplay = 300;
+        menuTime = millis();
+        return true;
+    }
+
+    bool handleWinlinkReply(PayloadKeyword keyword) {
+        const String& payload = lastReceivedPacket.payload;
+        bool isWinlinkAck = (keyword == KEYWORD_ACK && winlinkAckNumber == payload.c_str() + 3);
+
+        if (winlinkStatus == 0 && !Config.simplifiedTrackerMode) {
+            lastMsgRxTime = millis();
+            if (keyword != KEYWORD_ACK) {
+                saveNewMessage(0, lastReceivedPacket.sender, payload);
             }
+        } else if (winlinkStatus == 1 && isWinlinkAck) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Winlink","---> Waiting Challenge");
+            lastMsgRxTime = millis();
+            winlinkStatus = 2;
+            menuDisplay = 500;
+        } else if (keyword == KEYWORD_LOGIN_CHALLENGE) {
+            char challenge[32];
+            PayloadTokenizer tokens(payload);
+            tokens.skipPast('[');
+            tokens.next(']', challenge, sizeof(challenge));
+            WINLINK_Utils::processWinlinkChallenge(challenge);
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Challenge Received/Processed/Sent");
+            lastMsgRxTime = millis();
+            winlinkStatus = 3;
+            menuDisplay = 501;
+        } else if (winlinkStatus == 3 && isWinlinkAck) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Winlink","---> Challenge Ack Received");
+            lastMsgRxTime = millis();
+            winlinkStatus = 4;
+            menuDisplay = 502;
+        } else if (payload.indexOf("Login valid for") > 0) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Login Succesfull");
+            lastMsgRxTime = millis();
+            winlinkStatus = 5;
+            displayShow(" WINLINK>", "", " LOGGED !!!!", 2000);
+            cleanOutputAckRequestBuffer("WLNK-1");
+            menuDisplay = 5000;
+        } else if (winlinkStatus == 5 && keyword == KEYWORD_LOG_OFF) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Log Out");
+            lastMsgRxTime = millis();
+            displayShow(" WINLINK>", "", "    LOG OUT !!!", 2000);
+            cleanOutputAckRequestBuffer("WLNK-1");
+            lastChallengeTime = 0;
+            winlinkStatus = 0;
+        } else if (winlinkStatus == 5 && payload.indexOf("Log off successful") == -1 && payload.indexOf("Login valid") == -1 && payload.indexOf("Login [") == -1 && payload.indexOf("ack") == -1) {
+            lastMsgRxTime = millis();
+            displayShow("<WLNK Rx >", "", payload, 3000);
+            saveNewMessage(1, lastReceivedPacket.sender, payload);
         }
+        return true;
     }
 
-    void clean15SegBuffer() {
-        if (!packet15SegBuffer.empty() && (millis() - packet15SegBuffer[0].receivedTime) >  15 * 1000) packet15SegBuffer.erase(packet15SegBuffer.begin());
+    void handlePlainMessage(PayloadKeyword keyword) {
+        if (Config.simplifiedTrackerMode) return;
+        lastMsgRxTime = millis();
+
+        #ifdef HAS_TFT
+            #if defined(HELTEC_WIRELESS_TRACKER)
+                displayShow("< MSG Rx >", "From --> " + lastReceivedPacket.sender, lastReceivedPacket.payload , 3000);
+            #else   // T-Deck
+                displayShow("< MSG Rx >", "From --> " + lastReceivedPacket.sender, lastReceivedPacket.payload , 3000);
+            #endif
+        #else
+            displayShow("< MSG Rx >", "From --> " + lastReceivedPacket.sender, lastReceivedPacket.payload , "", "", "", 3000);
+        #endif
+
+        if (keyword != KEYWORD_ACK) {
+            saveNewMessage(0, lastReceivedPacket.sender, lastReceivedPacket.payload);
+        }
     }
 
-    bool check15SegBuffer(const String& station, const String& textMessage) {
-        if (!packet15SegBuffer.empty()) {
-            for (int i = 0; i < packet15SegBuffer.size(); i++) {
-                if (packet15SegBuffer[i].station == station && packet15SegBuffer[i].payload == textMessage) return false;
+    const SenderRoute senderRoutes[] = {
+        {"CA2RXU-15",   handleWeatherReply},
+        {"WLNK-1",      handleWinlinkReply}
+    };
+
+    // Messages addressed to us: the payload keyword is looked up once and the sender picks
+    // the handler, falling back to the plain message handling.
+    void dispatchMessage() {
+        PayloadKeyword keyword = MSGBUFFER_Utils::classifyPayload(lastReceivedPacket.payload.c_str());
+        if (keyword == KEYWORD_ACK) {
+            processAck(lastReceivedPacket.sender, lastReceivedPacket.payload.substring(3));
+        }
+        int ackRequest = lastReceivedPacket.payload.indexOf("{");
+        if (ackRequest >= 0) {
+            MSG_Utils::addToOutputBuffer(0, lastReceivedPacket.sender, "ack" + lastReceivedPacket.payload.substring(ackRequest + 1));
+            lastMsgRxTime = millis();
+            lastReceivedPacket.payload.remove(ackRequest);
+        }
+
+        if (Config.notification.buzzerActive && Config.notification.messageRxBeep) NOTIFICATION_Utils::messageBeep();
+
+        if (keyword == KEYWORD_PING) {
+            lastMsgRxTime = millis();
+            MSG_Utils::addToOutputBuffer(0, lastReceivedPacket.sender, "pong, 73!");
+        }
+
+        for (const SenderRoute& route : senderRoutes) {
+            if (lastReceivedPacket.sender == route.callsign) {
+                if (route.handler(keyword)) return;
+                break;
             }
         }
-        Packet15SegBuffer   packet;
-        packet.receivedTime = millis();
-        packet.station      = station;
-        packet.payload      = textMessage;
-        packet15SegBuffer.push_back(packet);
-        return true;
+        handlePlainMessage(keyword);
     }
 
-    void checkReceivedMessage(ReceivedLoRaPacket packet) {
-        if(packet.text.isEmpty()) {
+    void checkReceivedMessage(const LoRaFrame& packet) {
+        if (packet.length == 0) {
             return;
         }
-        if (packet.text.substring(0,3) == "\x3c\xff\x01") {              // its an APRS packet
-            //Serial.println(packet.text); // only for debug
-            lastReceivedPacket = APRSPacketLib::processReceivedPacket(packet.text.substring(3),packet.rssi, packet.snr, packet.freqError);
+        if (packet.isAPRS()) {              // its an APRS packet
+            //Serial.println(packet.data); // only for debug
+            lastReceivedPacket = APRSPacketLib::processReceivedPacket(packet.payload().data, packet.rssi, packet.snr, packet.freqError);
+            PACKETLOG_Utils::addReceived(packet, lastReceivedPacket.sender, lastReceivedPacket.type);
             if (lastReceivedPacket.sender != currentBeacon->callsign) {
 
                 if (lastReceivedPacket.payload.indexOf("\x3c\xff\x01") != -1) {
                     lastReceivedPacket.payload = lastReceivedPacket.payload.substring(0, lastReceivedPacket.payload.indexOf("\x3c\xff\x01"));
                 }
 
-                if (check15SegBuffer(lastReceivedPacket.sender, lastReceivedPacket.payload)) {
+                if (MSGBUFFER_Utils::checkDuplicate(lastReceivedPacket.sender.c_str(), lastReceivedPacket.payload.c_str(), millis(), Config.dedupTime * 1000UL)) {
 
                     if (digipeaterActive && lastReceivedPacket.addressee != currentBeacon->callsign) {
-                        String digipeatedPacket = APRSPacketLib::generateDigipeatedPacket(packet.text, currentBeacon->callsign, Config.path);
+                        String digipeatedPacket = APRSPacketLib::generateDigipeatedPacket(packet.data, currentBeacon->callsign, Config.path);
                         if (digipeatedPacket == "X") {
                             logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Main", "%s", "Packet won't be Repeated (Missing WIDEn-N)");
+                        } else if (!AIRTIME_Utils::canDigipeat()) {
+                            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Main", "%s", "Packet won't be Repeated (Airtime limit)");
                         } else {
-                            delay(500);
-                            LoRa_Utils::sendNewPacket(digipeatedPacket);
+                            TX_Utils::queuePacket(digipeatedPacket, TX_PRIORITY_DIGIPEAT, 500, false);
                         }
                     }
                     lastHeardTracker = lastReceivedPacket.sender;
 
                     if (lastReceivedPacket.type == 1 && lastReceivedPacket.addressee == currentBeacon->callsign) {
-
-                        if (ackRequestState && lastReceivedPacket.payload.indexOf("ack") == 0) {
-                            if (ackCallsignRequest == lastReceivedPacket.sender && ackNumberRequest == lastReceivedPacket.payload.substring(lastReceivedPacket.payload.indexOf("ack") + 3)) {
-                                outputAckRequestBuffer.erase(outputAckRequestBuffer.begin());
-                                ackRequestState = false;
-                            }
-                        }
-                        if (lastReceivedPacket.payload.indexOf("{") >= 0) {
-                            MSG_Utils::addToOutputBuffer(0, lastReceivedPacket.sender, "ack" + lastReceivedPacket.payload.substring(lastReceivedPacket.payload.indexOf("{") + 1));
-                            lastMsgRxTime = millis();
-                            lastReceivedPacket.payload = lastReceivedPacket.payload.substring(0, lastReceivedPacket.payload.indexOf("{"));
-                        }
-
-                        if (Config.notification.buzzerActive && Config.notification.messageRxBeep) NOTIFICATION_Utils::messageBeep();
-
-                        if (lastReceivedPacket.payload.indexOf("ping") == 0 || lastReceivedPacket.payload.indexOf("Ping") == 0 || lastReceivedPacket.payload.indexOf("PING") == 0) {
-                            lastMsgRxTime = millis();
-                            MSG_Utils::addToOutputBuffer(0, lastReceivedPacket.sender, "pong, 73!");
-                        }
-
-                        if (lastReceivedPacket.sender == "CA2RXU-15" && lastReceivedPacket.payload.indexOf("WX") == 0) {    // WX = WeatherReport
-                            Serial.println("Weather Report Received");
-                            const String& wxCleaning     = lastReceivedPacket.payload.substring(lastReceivedPacket.payload.indexOf("WX ") + 3);
-                            const String& place          = wxCleaning.substring(0,wxCleaning.indexOf(","));
-                            const String& placeCleaning  = wxCleaning.substring(wxCleaning.indexOf(",")+1);
-                            const String& summary        = placeCleaning.substring(0,placeCleaning.indexOf(","));
-                            const String& sumCleaning    = placeCleaning.substring(placeCleaning.indexOf(",")+2);
-                            const String& temperature    = sumCleaning.substring(0,sumCleaning.indexOf("P"));
-                            const String& tempCleaning   = sumCleaning.substring(sumCleaning.indexOf("P")+1);
-                            const String& pressure       = tempCleaning.substring(0,tempCleaning.indexOf("H"));
-                            const String& presCleaning   = tempCleaning.substring(tempCleaning.indexOf("H")+1);
-                            const String& humidity       = presCleaning.substring(0,presCleaning.indexOf("W"));
-                            const String& humCleaning    = presCleaning.substring(presCleaning.indexOf("W")+1);
-                            const String& windSpeed      = humCleaning.substring(0,humCleaning.indexOf(","));
-                            const String& windCleaning   = humCleaning.substring(humCleaning.indexOf(",")+1);
-                            const String& windDegrees    = windCleaning.substring(windCleaning.indexOf(",")+1,windCleaning.indexOf("\n"));
-
-                            String fifthLineWR = temperature;
-                            fifthLineWR += "C  ";
-                            fifthLineWR += pressure;
-                            fifthLineWR += "hPa  ";
-                            fifthLineWR += humidity;
-                            fifthLineWR += "%";
-
-                            String sixthLineWR = "(wind ";
-                            sixthLineWR += windSpeed;
-                            sixthLineWR += "m/s ";
-                            sixthLineWR += windDegrees;
-                            sixthLineWR += "deg)";
-
-                            displayShow("<WEATHER>", "From --> " + lastReceivedPacket.sender, place, summary, fifthLineWR, sixthLineWR);
-                            menuDisplay = 300;
-                            menuTime = millis();
-                        } else if (lastReceivedPacket.sender == "WLNK-1") {
-                            if (winlinkStatus == 0 && !Config.simplifiedTrackerMode) {
-                                lastMsgRxTime = millis();
-                                if (lastReceivedPacket.payload.indexOf("ack") != 0) {
-                                    saveNewMessage(0, lastReceivedPacket.sender, lastReceivedPacket.payload);
-                                }
-                            } else if (winlinkStatus == 1 && ackNumberRequest == lastReceivedPacket.payload.substring(lastReceivedPacket.payload.indexOf("ack") + 3)) {
-                                logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Winlink","---> Waiting Challenge");
-                                lastMsgRxTime = millis();
-                                winlinkStatus = 2;
-                                menuDisplay = 500;
-                            } else if ((winlinkStatus >= 1 || winlinkStatus <= 3) &&lastReceivedPacket.payload.indexOf("Login [") == 0) {
-                                WINLINK_Utils::processWinlinkChallenge(lastReceivedPacket.payload.substring(lastReceivedPacket.payload.indexOf("[")+1,lastReceivedPacket.payload.indexOf("]")));
-                                logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Challenge Received/Processed/Sent");
-                                lastMsgRxTime = millis();
-                                winlinkStatus = 3;
-                                menuDisplay = 501;
-                            } else if (winlinkStatus == 3 && ackNumberRequest == lastReceivedPacket.payload.substring(lastReceivedPacket.payload.indexOf("ack") + 3)) {
-                                logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Winlink","---> Challenge Ack Received");
-                                lastMsgRxTime = millis();
-                                winlinkStatus = 4;
-                                menuDisplay = 502;
-                            } else if (lastReceivedPacket.payload.indexOf("Login valid for") > 0) {
-                                logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Login Succesfull");
-                                lastMsgRxTime = millis();
-                                winlinkStatus = 5;
-                                displayShow(" WINLINK>", "", " LOGGED !!!!", 2000);
-                                cleanOutputAckRequestBuffer("WLNK-1");
-                                menuDisplay = 5000;
-                            } else if (winlinkStatus == 5 && lastReceivedPacket.payload.indexOf("Log off successful") == 0 ) {
-                                logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Winlink","---> Log Out");
-                                lastMsgRxTime = millis();
-                                displayShow(" WINLINK>", "", "    LOG OUT !!!", 2000);
-                                cleanOutputAckRequestBuffer("WLNK-1");
-                                lastChallengeTime = 0;
-                                winlinkStatus = 0;
-                            } else if ((winlinkStatus == 5) && (lastReceivedPacket.payload.indexOf("Log off successful") == -1) && (lastReceivedPacket.payload.indexOf("Login valid") == -1) && (lastReceivedPacket.payload.indexOf("Login [") == -1) && (lastReceivedPacket.payload.indexOf("ack") == -1)) {
-                                lastMsgRxTime = millis();
-                                displayShow("<WLNK Rx >", "", lastReceivedPacket.payload, 3000);
-                                saveNewMessage(1, lastReceivedPacket.sender, lastReceivedPacket.payload);
-                            }
-                        } else {
-                            if (!Config.simplifiedTrackerMode) {
-                                lastMsgRxTime = millis();
-
-                                #ifdef HAS_TFT
-                                    #if defined(HELTEC_WIRELESS_TRACKER)
-                                        displayShow("< MSG Rx >", "From --> " + lastReceivedPacket.sender, lastReceivedPacket.payload , 3000);
-                                    #else   // T-Deck
-                                        displayShow("< MSG Rx >", "From --> " + lastReceivedPacket.sender, lastReceivedPacket.payload , 3000);
-                                    #endif
-                                #else
-                                    displayShow("< MSG Rx >", "From --> " + lastReceivedPacket.sender, lastReceivedPacket.payload , "", "", "", 3000);
-                                #endif
-
-                                if (lastReceivedPacket.payload.indexOf("ack") != 0) {
-                                    saveNewMessage(0, lastReceivedPacket.sender, lastReceivedPacket.payload);
-                                }
-                            }
-                        }
+                        dispatchMessage();
                     } else {
                         if ((lastReceivedPacket.type == 0 || lastReceivedPacket.type == 4) && !Config.simplifiedTrackerMode) {
                             GPS_Utils::calculateDistanceCourse(lastReceivedPacket.sender, lastReceivedPacket.latitude, lastReceivedPacket.longitude);
@@ -0,0 +1,236 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "msgbuffer_utils.h"
+
+
+OutgoingMessage                 messagePool[MSG_POOL_SIZE];
+int8_t                          retryWheel[MSG_WHEEL_SLOTS];    // first message due in each tick
+int8_t                          ackBuckets[MSG_ACK_BUCKETS];    // messages waiting for an ack, by (addressee, msgno)
+uint32_t                        retryWheelTick      = 0;        // last tick processed
+uint32_t                        messageSequence     = 0;
+DuplicateEntry                  duplicateBuffer[DUPLICATE_BUFFER_SIZE];
+uint8_t                         duplicateBufferHead = 0;
+
+struct KeywordEntry {
+    const char*     text;
+    PayloadKeyword  keyword;
+};
+
+const KeywordEntry payloadKeywords[] = {
+    {"ack",                 KEYWORD_ACK},
+    {"ping",                KEYWORD_PING},
+    {"Ping",                KEYWORD_PING},
+    {"PING",                KEYWORD_PING},
+    {"WX",                  KEYWORD_WX},
+    {"Login [",             KEYWORD_LOGIN_CHALLENGE},
+    {"Log off successful",  KEYWORD_LOG_OFF}
+};
+
+TrieNode    payloadTrie[PAYLOAD_TRIE_SIZE];     // node 0 is the root
+uint8_t     payloadTrieSize     = 0;
+
+
+namespace MSGBUFFER_Utils {
+
+    uint32_t hashPacket(const char* station, const char* textMessage) {     // FNV-1a
+        uint32_t hash = 2166136261UL;
+        for (const char* c = station; *c; c++) hash = (hash ^ (uint8_t)*c) * 16777619UL;
+        hash = (hash ^ '>') * 16777619UL;
+        for (const char* c = textMessage; *c; c++) hash = (hash ^ (uint8_t)*c) * 16777619UL;
+        return hash == 0 ? 1 : hash;
+    }
+
+    uint8_t getAckBucket(const char* station, uint16_t msgNumber) {
+        char number[6];
+        snprintf(number, sizeof(number), "%u", msgNumber);
+        return hashPacket(station, number) % MSG_ACK_BUCKETS;
+    }
+
+    // Unlinks a message from a singly linked list threaded through the pool.
+    void unlink(int8_t& head, int8_t OutgoingMessage::*next, int8_t index) {
+        for (int8_t* link = &head; *link != -1; link = &(messagePool[*link].*next)) {
+            if (*link == index) {
+                *link = messagePool[index].*next;
+                return;
+            }
+        }
+    }
+
+    void addPayloadKeyword(const char* text, PayloadKeyword keyword) {
+        int8_t node = 0;
+        for (const char* c = text; *c; c++) {
+            int8_t child = payloadTrie[node].child;
+            while (child != -1 && payloadTrie[child].c != *c) child = payloadTrie[child].sibling;
+            if (child == -1) {
+                if (payloadTrieSize == PAYLOAD_TRIE_SIZE) return;
+                child = payloadTrieSize++;
+                payloadTrie[child] = {*c, -1, payloadTrie[node].child, KEYWORD_NONE};
+                payloadTrie[node].child = child;
+            }
+            node = child;
+        }
+        payloadTrie[node].keyword = keyword;
+    }
+
+    void setup(uint32_t now) {
+        memset(messagePool, 0, sizeof(messagePool));
+        memset(retryWheel, -1, sizeof(retryWheel));
+        memset(ackBuckets, -1, sizeof(ackBuckets));
+        memset(duplicateBuffer, 0, sizeof(duplicateBuffer));
+        duplicateBufferHead = 0;
+        retryWheelTick      = now / MSG_WHEEL_TICK;
+
+        payloadTrie[0]  = {'\0', -1, -1, KEYWORD_NONE};
+        payloadTrieSize = 1;
+        for (const KeywordEntry& entry : payloadKeywords) addPayloadKeyword(entry.text, entry.keyword);
+    }
+
+    // Takes a free slot for a message without ack number, or returns MSG_POOL_FULL /
+    // MSG_ALREADY_QUEUED if the same text for the same station is still in the pool.
+    int8_t addMessage(const char* station, const char* textMessage) {
+        int8_t slot = MSG_POOL_FULL;
+        for (int8_t i = 0; i < MSG_POOL_SIZE; i++) {
+            const OutgoingMessage& message = messagePool[i];
+            if (message.state == MSG_STATE_FREE) {
+                if (slot == MSG_POOL_FULL) slot = i;
+            } else if (strcmp(station, message.addressee) == 0 && strcmp(textMessage, message.text) == 0) {
+                return MSG_ALREADY_QUEUED;
+            }
+        }
+        if (slot == MSG_POOL_FULL) return slot;
+
+        OutgoingMessage& message = messagePool[slot];
+        strlcpy(message.addressee, station, sizeof(message.addressee));
+        strlcpy(message.text, textMessage, sizeof(message.text));
+        message.msgNumber   = 0;
+        message.tries       = 0;
+        message.sequence    = messageSequence++;
+        message.state       = MSG_STATE_PENDING;
+        return slot;
+    }
+
+    // Oldest message not sent yet, or -1.
+    int8_t nextPending() {
+        int8_t next = -1;
+        for (int8_t i = 0; i < MSG_POOL_SIZE; i++) {
+            if (messagePool[i].state != MSG_STATE_PENDING) continue;
+            if (next == -1 || (int32_t)(messagePool[i].sequence - messagePool[next].sequence) < 0) next = i;
+        }
+        return next;
+    }
+
+    void scheduleRetry(int8_t index, uint32_t dueTime) {
+        OutgoingMessage& message = messagePool[index];
+        message.dueTime = dueTime;
+        uint32_t tick = max(dueTime / MSG_WHEEL_TICK, retryWheelTick + 1);
+        message.wheelSlot   = tick % MSG_WHEEL_SLOTS;
+        message.nextInSlot  = retryWheel[message.wheelSlot];
+        retryWheel[message.wheelSlot] = index;
+    }
+
+    void waitForAck(int8_t index, uint32_t dueTime) {
+        OutgoingMessage& message = messagePool[index];
+        message.state = MSG_STATE_WAITING_ACK;
+        int8_t& bucket = ackBuckets[getAckBucket(message.addressee, message.msgNumber)];
+        message.nextInBucket = bucket;
+        bucket = index;
+        scheduleRetry(index, dueTime);
+    }
+
+    // Hands every message whose retry is due to the handler, which either expires it or
+    // schedules it again. Messages more than one turn of the wheel away go back on it.
+    void processWheel(uint32_t now, RetryHandler handler) {
+        uint32_t nowTick = now / MSG_WHEEL_TICK;
+        for (uint8_t steps = 0; retryWheelTick != nowTick && steps < MSG_WHEEL_SLOTS; steps++) {
+            retryWheelTick++;
+            int8_t index = retryWheel[retryWheelTick % MSG_WHEEL_SLOTS];
+            retryWheel[retryWheelTick % MSG_WHEEL_SLOTS] = -1;
+            while (index != -1) {
+                int8_t next = messagePool[index].nextInSlot;
+                if ((int32_t)(now - messagePool[index].dueTime) >= 0) {
+                    handler(index, now);
+                } else {
+                    scheduleRetry(index, messagePool[index].dueTime);
+                }
+                index = next;
+            }
+        }
+        retryWheelTick = nowTick;
+    }
+
+    // For a message the wheel has just handed out: it is no longer on the wheel itself.
+    void expireMessage(int8_t index) {
+        OutgoingMessage& message = messagePool[index];
+        unlink(ackBuckets[getAckBucket(message.addressee, message.msgNumber)], &OutgoingMessage::nextInBucket, index);
+        message.state = MSG_STATE_FREE;
+    }
+
+    void releaseMessage(int8_t index) {
+        OutgoingMessage& message = messagePool[index];
+        if (message.state == MSG_STATE_WAITING_ACK) {
+            unlink(retryWheel[message.wheelSlot], &OutgoingMessage::nextInSlot, index);
+            unlink(ackBuckets[getAckBucket(message.addressee, message.msgNumber)], &OutgoingMessage::nextInBucket, index);
+        }
+        message.state = MSG_STATE_FREE;
+    }
+
+    bool processAck(const char* station, uint16_t msgNumber) {
+        for (int8_t index = ackBuckets[getAckBucket(station, msgNumber)]; index != -1; index = messagePool[index].nextInBucket) {
+            if (messagePool[index].msgNumber == msgNumber && strcmp(station, messagePool[index].addressee) == 0) {
+                releaseMessage(index);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Stops waiting for any ack from the station.
+    void releaseMessages(const char* station) {
+        for (int8_t i = 0; i < MSG_POOL_SIZE; i++) {
+            if (messagePool[i].state == MSG_STATE_WAITING_ACK && strcmp(station, messagePool[i].addressee) == 0) releaseMessage(i);
+        }
+    }
+
+    // Longest keyword the payload starts with, found in one pass over its first characters.
+    PayloadKeyword classifyPayload(const char* payload) {
+        PayloadKeyword keyword = KEYWORD_NONE;
+        int8_t node = 0;
+        for (const char* c = payload; *c; c++) {
+            node = payloadTrie[node].child;
+            while (node != -1 && payloadTrie[node].c != *c) node = payloadTrie[node].sibling;
+            if (node == -1) break;
+            if (payloadTrie[node].keyword != KEYWORD_NONE) keyword = payloadTrie[node].keyword;
+        }
+        return keyword;
+    }
+
+    // Returns false if the same sender + payload was heard within the window (ms). Entries
+    // expire by age and the oldest one is overwritten, so nothing needs cleaning up.
+    bool checkDuplicate(const char* station, const char* textMessage, uint32_t now, uint32_t window) {
+        uint32_t hash = hashPacket(station, textMessage);
+        for (int i = 0; i < DUPLICATE_BUFFER_SIZE; i++) {
+            if (duplicateBuffer[i].hash == hash && (now - duplicateBuffer[i].receivedTime) < window) return false;
+        }
+        duplicateBuffer[duplicateBufferHead].hash           = hash;
+        duplicateBuffer[duplicateBufferHead].receivedTime   = now;
+        duplicateBufferHead = (duplicateBufferHead + 1) % DUPLICATE_BUFFER_SIZE;
+        return true;
+    }
+
+}
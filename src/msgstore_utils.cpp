@@ -0,0 +1,232 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <LittleFS.h>
+#include "msgstore_utils.h"
+#include "logger.h"
+
+/*  File layout:
+ *  [header: "MSG1", record size, capacity]
+ *  [record 0] ... [record capacity-1]      record = seq(4) length(2) crc(2) text(MSGSTORE_TEXT_SIZE)
+ *  A record lives in slot seq % capacity. Appends only ever write their own slot, so a torn write
+ *  only loses that record (its CRC fails) and the header never changes after creation.
+ */
+#define MSGSTORE_MAGIC          0x3147534D  // "MSG1"
+#define MSGSTORE_HEADER_SIZE    8
+#define MSGSTORE_EMPTY_SEQ      0xFFFFFFFF
+
+extern logging::Logger  logger;
+
+struct MessageRecord {
+    uint32_t    seq;
+    uint16_t    length;
+    uint16_t    crc;
+    char        text[MSGSTORE_TEXT_SIZE];
+};
+
+
+namespace MSGSTORE_Utils {
+
+    uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF) {    // CCITT
+        for (size_t i = 0; i < length; i++) {
+            crc ^= (uint16_t)data[i] << 8;
+            for (int bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+        return crc;
+    }
+
+    uint16_t recordCRC(const MessageRecord& record) {
+        uint16_t crc = crc16((const uint8_t*)&record.seq, sizeof(record.seq));
+        crc = crc16((const uint8_t*)&record.length, sizeof(record.length), crc);
+        return crc16((const uint8_t*)record.text, record.length, crc);
+    }
+
+    size_t slotOffset(const MessageStore& store, uint32_t seq) {
+        return MSGSTORE_HEADER_SIZE + (seq % store.capacity) * MSGSTORE_RECORD_SIZE;
+    }
+
+    bool isValid(const MessageStore& store, uint32_t seq) {
+        uint16_t slot = seq % store.capacity;
+        return store.validSlots[slot / 8] & (1 << (slot % 8));
+    }
+
+    void setValid(MessageStore& store, uint32_t seq, bool valid) {
+        uint16_t slot = seq % store.capacity;
+        if (valid) {
+            store.validSlots[slot / 8] |= (1 << (slot % 8));
+        } else {
+            store.validSlots[slot / 8] &= ~(1 << (slot % 8));
+        }
+    }
+
+    bool findSeq(const MessageStore& store, uint16_t index, uint32_t& seq) {   // index-th valid record, torn ones skipped
+        for (seq = store.firstSeq; seq != store.nextSeq; seq++) {
+            if (isValid(store, seq) && index-- == 0) return true;
+        }
+        return false;
+    }
+
+    bool readRecord(MessageStore& store, uint32_t seq, MessageRecord& record) {
+        if (!store.file.seek(slotOffset(store, seq))) return false;
+        if (store.file.read((uint8_t*)&record, sizeof(record)) != sizeof(record)) return false;
+        return record.seq == seq && record.length <= MSGSTORE_TEXT_SIZE && record.crc == recordCRC(record);
+    }
+
+    bool create(MessageStore& store) {
+        File file = LittleFS.open(store.path, FILE_WRITE);
+        if (!file) return false;
+        uint32_t header[2] = {MSGSTORE_MAGIC, ((uint32_t)store.capacity << 16) | MSGSTORE_RECORD_SIZE};
+        file.write((const uint8_t*)header, sizeof(header));
+        MessageRecord empty;
+        memset(&empty, 0xFF, sizeof(empty));
+        for (int i = 0; i < store.capacity; i++) file.write((const uint8_t*)&empty, sizeof(empty));
+        file.close();
+        return true;
+    }
+
+    // Bounded by capacity, not by how many messages came in. Torn records and ones left over
+    // from an earlier turn of the file (a failed overwrite) are not counted.
+    bool scan(MessageStore& store) {
+        uint32_t header[2];
+        store.file.seek(0);
+        if (store.file.read((uint8_t*)header, sizeof(header)) != sizeof(header)) return false;
+        if (header[0] != MSGSTORE_MAGIC || header[1] != (((uint32_t)store.capacity << 16) | MSGSTORE_RECORD_SIZE)) return false;
+
+        uint32_t    slotSeq[MSGSTORE_MAX_CAPACITY];
+        bool        found   = false;
+        uint32_t    maxSeq  = 0;
+        MessageRecord record;
+        for (int slot = 0; slot < store.capacity; slot++) {
+            slotSeq[slot] = MSGSTORE_EMPTY_SEQ;
+            store.file.seek(MSGSTORE_HEADER_SIZE + slot * MSGSTORE_RECORD_SIZE);
+            if (store.file.read((uint8_t*)&record, sizeof(record)) != sizeof(record)) return false;
+            if (record.seq == MSGSTORE_EMPTY_SEQ || record.seq % store.capacity != (uint32_t)slot) continue;
+            if (record.length > MSGSTORE_TEXT_SIZE || record.crc != recordCRC(record)) continue;    // torn append
+            slotSeq[slot] = record.seq;
+            if (!found || record.seq > maxSeq) maxSeq = record.seq;
+            found = true;
+        }
+
+        memset(store.validSlots, 0, sizeof(store.validSlots));
+        store.nextSeq   = found ? maxSeq + 1 : 0;
+        store.firstSeq  = store.nextSeq;
+        store.count     = 0;
+        for (int slot = 0; slot < store.capacity; slot++) {
+            if (slotSeq[slot] == MSGSTORE_EMPTY_SEQ || store.nextSeq - slotSeq[slot] > store.capacity) continue;
+            if (slotSeq[slot] < store.firstSeq) store.firstSeq = slotSeq[slot];
+            setValid(store, slotSeq[slot], true);
+            store.count++;
+        }
+        return true;
+    }
+
+    void migrate(MessageStore& store, const char *legacyPath) {   // one line per message, from the old .txt
+        File legacyFile = LittleFS.open(legacyPath, FILE_READ);
+        if (!legacyFile) return;
+        int migrated = 0;
+        while (legacyFile.available()) {
+            String line = legacyFile.readStringUntil('\n');
+            line.trim();
+            if (line.length() > 0 && append(store, line)) migrated++;
+        }
+        legacyFile.close();
+        LittleFS.remove(legacyPath);
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "MsgStore", "%d messages moved from %s", migrated, legacyPath);
+    }
+
+    bool open(MessageStore& store, const char *legacyPath) {
+        if (store.file) store.file.close();
+        store.firstSeq  = 0;
+        store.nextSeq   = 0;
+        store.count     = 0;
+        memset(store.validSlots, 0, sizeof(store.validSlots));
+        if (store.capacity > MSGSTORE_MAX_CAPACITY) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "MsgStore", "%s: capacity over %d", store.path, MSGSTORE_MAX_CAPACITY);
+            return false;
+        }
+        for (int attempt = 0; attempt < 2; attempt++) {
+            if (!LittleFS.exists(store.path) && !create(store)) break;
+            store.file = LittleFS.open(store.path, "r+");
+            if (store.file && scan(store)) {
+                if (legacyPath != nullptr && LittleFS.exists(legacyPath)) migrate(store, legacyPath);
+                return true;
+            }
+            if (store.file) store.file.close();
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "MsgStore", "%s unreadable, recreating", store.path);
+            LittleFS.remove(store.path);
+        }
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "MsgStore", "Can't open %s", store.path);
+        return false;
+    }
+
+    bool append(MessageStore& store, const String& text) {
+        if (!store.file) return false;
+        MessageRecord record;
+        memset(&record, 0, sizeof(record));
+        record.seq      = store.nextSeq;
+        record.length   = min((size_t)text.length(), (size_t)MSGSTORE_TEXT_SIZE);
+        memcpy(record.text, text.c_str(), record.length);
+        record.crc      = recordCRC(record);
+
+        if (store.nextSeq - store.firstSeq == store.capacity) {     // the slot holds the oldest record
+            if (isValid(store, store.firstSeq)) store.count--;
+            setValid(store, store.firstSeq, false);
+            store.firstSeq++;
+        }
+        store.nextSeq++;
+        if (!store.file.seek(slotOffset(store, record.seq)) || store.file.write((const uint8_t*)&record, sizeof(record)) != sizeof(record)) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "MsgStore", "Append to %s failed", store.path);
+            return false;
+        }
+        store.file.flush();
+        setValid(store, record.seq, true);
+        store.count++;
+        return true;
+    }
+
+    bool read(MessageStore& store, uint16_t index, String& text) {     // 0 = oldest
+        text = "";
+        uint32_t seq;
+        if (!store.file || index >= store.count || !findSeq(store, index, seq)) return false;
+        MessageRecord record;
+        if (!readRecord(store, seq, record)) return false;
+        text.reserve(record.length);
+        for (int i = 0; i < record.length; i++) text += record.text[i];
+        return true;
+    }
+
+    uint16_t readPage(MessageStore& store, uint16_t firstIndex, String *texts, uint16_t pageSize) {
+        uint16_t readCount = 0;
+        while (readCount < pageSize && firstIndex + readCount < store.count) {
+            read(store, firstIndex + readCount, texts[readCount]);
+            readCount++;
+        }
+        return readCount;
+    }
+
+    uint16_t count(const MessageStore& store) {
+        return store.count;
+    }
+
+    void clear(MessageStore& store) {
+        if (store.file) store.file.close();
+        LittleFS.remove(store.path);
+        open(store);
+    }
+
+}
@@ -0,0 +1,325 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "packetlog_utils.h"
+#include "storage_utils.h"
+#include "configuration.h"
+#include "TimeLib.h"
+#include "logger.h"
+
+extern Configuration    Config;
+extern Beacon           *currentBeacon;
+extern logging::Logger  logger;
+
+#define PACKETLOG_FILE          "/packets.bin"
+#define PACKETLOG_OLD_FILE      "/packets.old.bin"
+#define PACKETLOG_FILE_MAGIC    0x31474C50      // "PLG1", written at the start of each file
+
+#define SOURCE_OLD_FILE         0
+#define SOURCE_FILE             1
+#define SOURCE_RING             2
+#define SOURCE_DONE             3
+
+
+PacketLogEntry  *packetLogEntries   = nullptr;
+uint8_t         *packetLogArena     = nullptr;
+uint16_t        packetLogMaxEntries = 0;
+uint32_t        packetLogArenaSize  = 0;
+
+uint16_t        packetLogFirst      = 0;
+uint16_t        packetLogCount      = 0;
+uint32_t        packetLogArenaHead  = 0;
+uint32_t        packetLogSequence   = 0;    // of the next entry
+uint32_t        packetLogFlushed    = 0;    // entries before this sequence are on flash
+uint32_t        packetLogFlushTime  = 0;
+
+portMUX_TYPE    packetLogLock       = portMUX_INITIALIZER_UNLOCKED;
+
+
+namespace PACKETLOG_Utils {
+
+    void setup() {
+        #ifdef BOARD_HAS_PSRAM
+            if (psramFound()) {
+                packetLogEntries    = (PacketLogEntry*)ps_malloc(PACKETLOG_PSRAM_ENTRIES * sizeof(PacketLogEntry));
+                packetLogArena      = (uint8_t*)ps_malloc(PACKETLOG_PSRAM_ARENA_SIZE);
+                packetLogMaxEntries = PACKETLOG_PSRAM_ENTRIES;
+                packetLogArenaSize  = PACKETLOG_PSRAM_ARENA_SIZE;
+            }
+        #endif
+        if (packetLogEntries == nullptr || packetLogArena == nullptr) {
+            free(packetLogEntries);
+            free(packetLogArena);
+            packetLogEntries    = (PacketLogEntry*)malloc(PACKETLOG_ENTRIES * sizeof(PacketLogEntry));
+            packetLogArena      = (uint8_t*)malloc(PACKETLOG_ARENA_SIZE);
+            packetLogMaxEntries = PACKETLOG_ENTRIES;
+            packetLogArenaSize  = PACKETLOG_ARENA_SIZE;
+        }
+        if (packetLogEntries == nullptr || packetLogArena == nullptr) packetLogMaxEntries = 0;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "PacketLog", "%u entries, %u bytes", (unsigned int)packetLogMaxEntries, (unsigned int)packetLogArenaSize);
+    }
+
+    uint32_t hashCallsign(const char* callsign) {     // FNV-1a
+        uint32_t hash = 2166136261UL;
+        for (const char* c = callsign; *c; c++) hash = (hash ^ (uint8_t)*c) * 16777619UL;
+        return hash;
+    }
+
+    // Must be called with packetLogLock held.
+    PacketLogEntry& getEntry(uint32_t sequence) {
+        uint32_t oldest = packetLogSequence - packetLogCount;
+        return packetLogEntries[(packetLogFirst + (sequence - oldest)) % packetLogMaxEntries];
+    }
+
+    void dropOldest() {
+        packetLogFirst = (packetLogFirst + 1) % packetLogMaxEntries;
+        packetLogCount--;
+    }
+
+    // The arena is written in the same order as the entries, so the frames about to be
+    // overwritten always belong to the oldest entries.
+    void consumeArena(uint32_t start, uint32_t end) {
+        while (packetLogCount > 0) {
+            uint16_t offset = packetLogEntries[packetLogFirst].payloadOffset;
+            if (offset < start || offset >= end) break;
+            dropOldest();
+        }
+    }
+
+    void addEntry(PacketLogEntry& entry, const char* payload) {
+        if (packetLogMaxEntries == 0) return;
+        entry.epoch = (timeStatus() == timeSet) ? now() : 0;
+
+        portENTER_CRITICAL(&packetLogLock);
+        if (packetLogCount == packetLogMaxEntries) dropOldest();
+        uint32_t start = packetLogArenaHead;
+        if (start + entry.payloadLength > packetLogArenaSize) {
+            consumeArena(start, packetLogArenaSize);
+            start = 0;
+        }
+        consumeArena(start, start + entry.payloadLength);
+        memcpy(packetLogArena + start, payload, entry.payloadLength);
+        packetLogArenaHead  = start + entry.payloadLength;
+        entry.payloadOffset = start;
+        packetLogEntries[(packetLogFirst + packetLogCount) % packetLogMaxEntries] = entry;
+        packetLogCount++;
+        packetLogSequence++;
+        portEXIT_CRITICAL(&packetLogLock);
+    }
+
+    void addReceived(const LoRaFrame& frame, const String& sender, uint8_t type) {
+        StringView payload = frame.payload();
+        PacketLogEntry entry;
+        entry.uptime        = millis();
+        entry.senderHash    = hashCallsign(sender.c_str());
+        entry.payloadLength = min(payload.length, (size_t)UINT8_MAX);
+        entry.type          = type;
+        entry.direction     = PACKETLOG_RX;
+        entry.snr           = constrain(frame.snr * 4, INT8_MIN, INT8_MAX);
+        entry.rssi          = frame.rssi;
+        entry.freqError     = frame.freqError;
+        addEntry(entry, payload.data);
+    }
+
+    void addTransmitted(const char* frame, size_t length) {
+        PacketLogEntry entry;
+        entry.uptime        = millis();
+        entry.senderHash    = hashCallsign(currentBeacon->callsign.c_str());
+        entry.payloadLength = min(length, (size_t)UINT8_MAX);
+        entry.type          = 0;
+        entry.direction     = PACKETLOG_TX;
+        entry.snr           = 0;
+        entry.rssi          = 0;
+        entry.freqError     = 0;
+        addEntry(entry, frame);
+    }
+
+    // Copies an entry and its frame out of the ring; false if it was already overwritten.
+    bool copyEntry(uint32_t sequence, PacketLogEntry& entry, char* payload) {
+        bool available;
+        portENTER_CRITICAL(&packetLogLock);
+        available = (packetLogSequence - sequence) <= packetLogCount && sequence != packetLogSequence;
+        if (available) {
+            entry = getEntry(sequence);
+            memcpy(payload, packetLogArena + entry.payloadOffset, entry.payloadLength);
+        }
+        portEXIT_CRITICAL(&packetLogLock);
+        return available;
+    }
+
+    File openLogFile(const char* path, const char* mode) {
+        File file = LittleFS.open(path, mode);
+        if (file && strcmp(mode, FILE_READ) == 0) {
+            uint32_t magic = 0;
+            if (file.read((uint8_t*)&magic, sizeof(magic)) != sizeof(magic) || magic != PACKETLOG_FILE_MAGIC) file.close();
+        }
+        return file;
+    }
+
+    // Appends the entries logged since the last flush; the file is rolled over to .old
+    // once it reaches PACKETLOG_FILE_SIZE, so at most two files are kept.
+    void flush(bool force) {
+        if (!Config.packetLog || packetLogMaxEntries == 0) return;
+        if (!force && millis() - packetLogFlushTime < PACKETLOG_FLUSH_INTERVAL) return;
+        packetLogFlushTime = millis();
+        if (packetLogFlushed == packetLogSequence) return;
+
+        if (LittleFS.exists(PACKETLOG_FILE)) {
+            File current = LittleFS.open(PACKETLOG_FILE, FILE_READ);
+            size_t size = current.size();
+            current.close();
+            if (size >= PACKETLOG_FILE_SIZE) {
+                LittleFS.remove(PACKETLOG_OLD_FILE);
+                LittleFS.rename(PACKETLOG_FILE, PACKETLOG_OLD_FILE);
+            }
+        }
+        bool newFile = !LittleFS.exists(PACKETLOG_FILE);
+        File file = LittleFS.open(PACKETLOG_FILE, FILE_APPEND);
+        if (!file) return;
+        if (newFile) {
+            uint32_t magic = PACKETLOG_FILE_MAGIC;
+            file.write((uint8_t*)&magic, sizeof(magic));
+        }
+
+        uint32_t oldest = packetLogSequence - packetLogCount;
+        uint32_t written = 0;
+        PacketLogEntry entry;
+        char payload[UINT8_MAX];
+        for (uint32_t sequence = max(packetLogFlushed, oldest); sequence != packetLogSequence; sequence++) {
+            if (!copyEntry(sequence, entry, payload)) continue;
+            file.write((uint8_t*)&entry, sizeof(entry));
+            file.write((uint8_t*)payload, entry.payloadLength);
+            written++;
+        }
+        file.close();
+        packetLogFlushed = packetLogSequence;
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "PacketLog", "%u packets written to flash", (unsigned int)written);
+    }
+
+    void openCursor(PacketLogCursor& cursor, PacketLogFormat format, const String& sender) {
+        cursor.format       = format;
+        cursor.senderHash   = sender.isEmpty() ? 0 : hashCallsign(sender.c_str());
+        cursor.source       = SOURCE_OLD_FILE;
+        cursor.file         = openLogFile(PACKETLOG_OLD_FILE, FILE_READ);
+        portENTER_CRITICAL(&packetLogLock);
+        cursor.nextSequence = max(packetLogFlushed, packetLogSequence - packetLogCount);
+        cursor.endSequence  = packetLogSequence;
+        portEXIT_CRITICAL(&packetLogLock);
+        cursor.written      = 0;
+        cursor.linePosition = 0;
+        cursor.lineLength   = (format == PACKETLOG_JSON)
+                            ? strlcpy(cursor.line, "[", sizeof(cursor.line))
+                            : strlcpy(cursor.line, "epoch,uptime,direction,sender,type,rssi,snr,freqError,frame\n", sizeof(cursor.line));
+    }
+
+    // Next packet from the old file, the current file and then the RAM ring.
+    bool readNext(PacketLogCursor& cursor, PacketLogEntry& entry, char* payload) {
+        while (cursor.source != SOURCE_DONE) {
+            if (cursor.source == SOURCE_RING) {
+                if (cursor.nextSequence == cursor.endSequence) {
+                    cursor.source = SOURCE_DONE;
+                } else if (copyEntry(cursor.nextSequence++, entry, payload)) {
+                    return true;
+                }
+            } else if (cursor.file && cursor.file.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry)
+                        && cursor.file.read((uint8_t*)payload, entry.payloadLength) == entry.payloadLength) {
+                return true;
+            } else {
+                cursor.file.close();
+                cursor.source++;
+                if (cursor.source == SOURCE_FILE) cursor.file = openLogFile(PACKETLOG_FILE, FILE_READ);
+            }
+        }
+        return false;
+    }
+
+    size_t appendEscaped(char* line, size_t length, const char* payload, size_t payloadLength, PacketLogFormat format) {
+        for (size_t i = 0; i < payloadLength && length < PACKETLOG_LINE_SIZE - 8; i++) {
+            uint8_t c = payload[i];
+            if (format == PACKETLOG_JSON) {
+                if (c == '"' || c == '\\') {
+                    line[length++] = '\\';
+                    line[length++] = c;
+                } else if (c < 0x20 || c >= 0x7F) {
+                    length += snprintf(line + length, 7, "\\u%04x", c);
+                } else {
+                    line[length++] = c;
+                }
+            } else {
+                if (c == '"') line[length++] = '"';
+                line[length++] = (c < 0x20) ? ' ' : c;
+            }
+        }
+        return length;
+    }
+
+    void formatEntry(PacketLogCursor& cursor, const PacketLogEntry& entry, const char* payload) {
+        const char* direction = (entry.direction == PACKETLOG_TX) ? "tx" : "rx";
+        size_t length;
+        if (cursor.format == PACKETLOG_JSON) {
+            length = snprintf(cursor.line, PACKETLOG_LINE_SIZE,
+                        "%s{\"epoch\":%lu,\"uptime\":%lu,\"direction\":\"%s\",\"sender\":\"%08lx\",\"type\":%u,\"rssi\":%d,\"snr\":%.2f,\"freqError\":%ld,\"frame\":\"",
+                        cursor.written > 0 ? "," : "", (unsigned long)entry.epoch, (unsigned long)entry.uptime, direction, (unsigned long)entry.senderHash,
+                        (unsigned int)entry.type, (int)entry.rssi, entry.snr / 4.0, (long)entry.freqError);
+            length = appendEscaped(cursor.line, length, payload, entry.payloadLength, cursor.format);
+            length += strlcpy(cursor.line + length, "\"}", PACKETLOG_LINE_SIZE - length);
+        } else {
+            length = snprintf(cursor.line, PACKETLOG_LINE_SIZE, "%lu,%lu,%s,%08lx,%u,%d,%.2f,%ld,\"",
+                        (unsigned long)entry.epoch, (unsigned long)entry.uptime, direction, (unsigned long)entry.senderHash,
+                        (unsigned int)entry.type, (int)entry.rssi, entry.snr / 4.0, (long)entry.freqError);
+            length = appendEscaped(cursor.line, length, payload, entry.payloadLength, cursor.format);
+            length += strlcpy(cursor.line + length, "\"\n", PACKETLOG_LINE_SIZE - length);
+        }
+        cursor.lineLength   = length;
+        cursor.linePosition = 0;
+        cursor.written++;
+    }
+
+    // Fills one chunk of the export; packets are formatted one at a time into the cursor's
+    // line buffer, so the response never needs more RAM than one escaped packet.
+    size_t readChunk(PacketLogCursor& cursor, uint8_t* buffer, size_t maxLength) {
+        size_t filled = 0;
+        PacketLogEntry entry;
+        char payload[UINT8_MAX];
+        while (filled < maxLength) {
+            if (cursor.linePosition == cursor.lineLength) {
+                if (cursor.source == SOURCE_DONE) break;
+                bool found = false;
+                while (readNext(cursor, entry, payload)) {
+                    if (cursor.senderHash == 0 || entry.senderHash == cursor.senderHash) {
+                        found = true;
+                        break;
+                    }
+                }
+                if (found) {
+                    formatEntry(cursor, entry, payload);
+                } else {
+                    cursor.lineLength   = (cursor.format == PACKETLOG_JSON) ? strlcpy(cursor.line, "]", sizeof(cursor.line)) : 0;
+                    cursor.linePosition = 0;
+                    if (cursor.lineLength == 0) break;
+                }
+            }
+            size_t count = min(cursor.lineLength - cursor.linePosition, maxLength - filled);
+            memcpy(buffer + filled, cursor.line + cursor.linePosition, count);
+            cursor.linePosition += count;
+            filled              += count;
+        }
+        return filled;
+    }
+
+}
@@ -22,6 +22,9 @@
 #include "battery_utils.h"
 #include "board_pinout.h"
 #include "power_utils.h"
+#include "packetlog_utils.h"
+#include "storage_utils.h"
+#include "tx_utils.h"
 #include "lora_utils.h"
 #include "ble_utils.h"
 #include "gps_utils.h"
@@ -264,6 +267,18 @@ namespace POWER_Utils {
         }
     }
 
+    // Pins of a replaced configuration go back to inputs before externalPinSetup() claims the new ones.
+    void externalPinRelease(const Configuration& config) {
+        if (config.notification.buzzerActive) {
+            if (config.notification.buzzerPinTone >= 0) pinMode(config.notification.buzzerPinTone, INPUT);
+            if (config.notification.buzzerPinVcc >= 0) pinMode(config.notification.buzzerPinVcc, INPUT);
+        }
+        if (config.notification.ledTx && config.notification.ledTxPin >= 0) pinMode(config.notification.ledTxPin, INPUT);
+        if (config.notification.ledMessage && config.notification.ledMessagePin >= 0) pinMode(config.notification.ledMessagePin, INPUT);
+        if (config.notification.ledFlashlight && config.notification.ledFlashlightPin >= 0) pinMode(config.notification.ledFlashlightPin, INPUT);
+        if (config.ptt.active && config.ptt.io_pin >= 0) pinMode(config.ptt.io_pin, INPUT);
+    }
+
     bool begin(TwoWire &port) {
         #if !defined(HAS_AXP192) && !defined(HAS_AXP2101)
             return true; // no powerManagment chip for this boards (only a few measure battery voltage).
@@ -427,6 +442,9 @@ namespace POWER_Utils {
     }
 
     void shutdown() {
+        STORAGE_Utils::flush(true);
+        TX_Utils::flush();
+        PACKETLOG_Utils::flush(true);
         delay(3000);
         logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "Main", "SHUTDOWN !!!");
         #if defined(HAS_AXP192) || defined(HAS_AXP2101)
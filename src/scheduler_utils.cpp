@@ -0,0 +1,149 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <logger.h>
+#include <atomic>
+#include "scheduler_utils.h"
+
+extern logging::Logger  logger;
+
+#define SCHEDULER_MAX_IDLE  1000    // ms, upper bound when no periodic job is due
+
+
+namespace SCHEDULER_Utils {
+
+    SchedulerJob            jobs[SCHEDULER_MAX_JOBS];
+    uint8_t                 jobCount        = 0;
+    TaskHandle_t            loopTaskHandle  = NULL;
+    std::atomic<uint32_t>   pendingEvents(0);
+    IdleHook                idleHook        = NULL;
+    bool                    lowPowerIdle    = false;
+
+    void defaultIdle(uint32_t idleTime) {
+        waitForEvent(idleTime);
+    }
+
+    uint32_t waitForEvent(uint32_t timeout) {   // loop task only
+        if (pendingEvents.load() == 0 && timeout > 0) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout));
+        return pendingEvents.load();
+    }
+
+    void signalEvent(uint32_t event) {
+        pendingEvents.fetch_or(event);
+        if (loopTaskHandle != NULL) xTaskNotifyGive(loopTaskHandle);
+    }
+
+    void IRAM_ATTR signalEventFromISR(uint32_t event) {
+        pendingEvents.fetch_or(event);
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        if (loopTaskHandle != NULL) vTaskNotifyGiveFromISR(loopTaskHandle, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken == pdTRUE) portYIELD_FROM_ISR();
+    }
+
+    int addJob(const char *name, JobFunction function, uint32_t period, uint32_t eventMask, uint32_t lowPowerPeriod) {
+        if (jobCount >= SCHEDULER_MAX_JOBS) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_ERROR, "Scheduler", "No room for job %s", name);
+            return -1;
+        }
+        SchedulerJob& job   = jobs[jobCount];
+        job.name            = name;
+        job.function        = function;
+        job.period          = period;
+        job.lowPowerPeriod  = (lowPowerPeriod > 0) ? lowPowerPeriod : period;
+        job.eventMask       = eventMask;
+        job.nextRun         = millis();     // periodic jobs run on the first pass
+        job.runs            = 0;
+        job.totalTime       = 0;
+        job.maxTime         = 0;
+        return jobCount++;
+    }
+
+    void setIdleHook(IdleHook hook) {
+        idleHook = (hook != NULL) ? hook : defaultIdle;
+    }
+
+    void setLowPower(bool lowPower) {
+        if (lowPower == lowPowerIdle) return;
+        lowPowerIdle = lowPower;
+        if (lowPower) return;
+        uint32_t currentTime = millis();   // leaving low power: don't wait out the long periods
+        for (int i = 0; i < jobCount; i++) {
+            if (jobs[i].period == 0) continue;
+            if ((int32_t)(jobs[i].nextRun - (currentTime + jobs[i].period)) > 0) jobs[i].nextRun = currentTime + jobs[i].period;
+        }
+    }
+
+    void runJob(SchedulerJob& job) {
+        uint32_t startTime = micros();
+        job.function();
+        uint32_t runTime = micros() - startTime;
+        job.runs++;
+        job.totalTime += runTime;
+        if (runTime > job.maxTime) job.maxTime = runTime;
+        job.nextRun = millis() + (lowPowerIdle ? job.lowPowerPeriod : job.period);
+    }
+
+    void run() {
+        uint32_t events     = pendingEvents.exchange(0);
+        uint32_t jobsRun    = 0;    // each job at most once per pass
+
+        for (int i = 0; i < jobCount; i++) {
+            if (jobs[i].eventMask & events) {
+                runJob(jobs[i]);
+                jobsRun |= (1 << i);
+            }
+        }
+
+        for (;;) {                  // due periodic jobs, earliest deadline first
+            uint32_t currentTime = millis();
+            int nextJob = -1;
+            for (int i = 0; i < jobCount; i++) {
+                if (jobs[i].period == 0 || (jobsRun & (1 << i)) || (int32_t)(currentTime - jobs[i].nextRun) < 0) continue;
+                if (nextJob < 0 || (int32_t)(jobs[i].nextRun - jobs[nextJob].nextRun) < 0) nextJob = i;
+            }
+            if (nextJob < 0) break;
+            runJob(jobs[nextJob]);
+            jobsRun |= (1 << nextJob);
+        }
+
+        if (idleHook == NULL || pendingEvents.load() != 0) return;
+        uint32_t currentTime    = millis();
+        uint32_t idleTime       = SCHEDULER_MAX_IDLE;
+        for (int i = 0; i < jobCount; i++) {
+            if (jobs[i].period == 0) continue;
+            int32_t timeToRun = (int32_t)(jobs[i].nextRun - currentTime);
+            if (timeToRun <= 0) return;
+            if ((uint32_t)timeToRun < idleTime) idleTime = timeToRun;
+        }
+        idleHook(idleTime);
+    }
+
+    void logStats() {
+        for (int i = 0; i < jobCount; i++) {
+            const SchedulerJob& job = jobs[i];
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Scheduler", "%-12s runs: %u avg: %u us max: %u us",
+                        job.name, (unsigned int)job.runs, (unsigned int)((job.runs > 0) ? job.totalTime / job.runs : 0), (unsigned int)job.maxTime);
+        }
+    }
+
+    void setup() {              // called from setup(), which runs on the loop task
+        loopTaskHandle  = xTaskGetCurrentTaskHandle();
+        if (idleHook == NULL) idleHook = defaultIdle;
+    }
+
+}
@@ -16,16 +16,37 @@
  * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <driver/uart.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <WiFi.h>
+#include <logger.h>
+#include "scheduler_utils.h"
+#include "button_utils.h"
 #include "board_pinout.h"
 #include "sleep_utils.h"
 #include "power_utils.h"
+#include "lora_utils.h"
 
+#define LIGHT_SLEEP_MIN_TIME    20      // ms, shorter idle times just wait
+#define GPS_UART                UART_NUM_1
+#define GPS_BURST_GAP           300     // ms of silence between two NMEA bursts
+#define GPS_BURST_GUARD         250     // ms awake ahead of the next burst, onReceive() reports it late
+#define GPS_SILENT_TIME         1500    // ms without NMEA before ignoring the burst timing
 
+
+extern logging::Logger  logger;
 extern uint32_t         lastGPSTime;
 extern bool             gpsIsActive;
+extern bool             displayState;
+extern bool             bluetoothActive;
 
 bool gpsShouldSleep     = false;
 
+volatile uint32_t   gpsBurstTime        = 0;    // first NMEA data of the last burst
+volatile uint32_t   gpsActivityTime     = 0;
+LightSleepStats     lightSleepStats     = {0, 0, 0, 0, 0, 0};
+
 
 namespace SLEEP_Utils {
 
@@ -59,4 +80,83 @@ namespace SLEEP_Utils {
         }
     }
 
+    void gpsDataReceived() {    // UART event task
+        uint32_t currentTime = millis();
+        if (currentTime - gpsActivityTime > GPS_BURST_GAP) gpsBurstTime = currentTime;
+        gpsActivityTime = currentTime;
+    }
+
+    uint32_t timeToNextGPSBurst(uint32_t currentTime) {
+        if (!gpsIsActive || currentTime - gpsActivityTime > GPS_SILENT_TIME) return UINT32_MAX;
+        int32_t timeToBurst = (int32_t)(gpsBurstTime + 1000 - GPS_BURST_GUARD - currentTime);
+        return (timeToBurst > 0) ? timeToBurst : 0;
+    }
+
+    void countWakeup(bool radioIrq) {
+        switch (esp_sleep_get_wakeup_cause()) {
+            case ESP_SLEEP_WAKEUP_TIMER:
+                lightSleepStats.timerWakeups++;
+                break;
+            case ESP_SLEEP_WAKEUP_UART:
+                lightSleepStats.gpsWakeups++;
+                break;
+            case ESP_SLEEP_WAKEUP_GPIO:
+                if (radioIrq) {
+                    lightSleepStats.radioWakeups++;
+                } else {
+                    lightSleepStats.buttonWakeups++;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void lightSleepIdle(uint32_t idleTime) {    // scheduler idle hook
+        bool canSleep = !displayState && !bluetoothActive && WiFi.getMode() == WIFI_OFF;
+        SCHEDULER_Utils::setLowPower(canSleep);
+
+        uint32_t sleepTime = min(idleTime, timeToNextGPSBurst(millis()));
+        if (!canSleep || sleepTime < LIGHT_SLEEP_MIN_TIME || !LoRa_Utils::prepareForLightSleep()) {
+            SCHEDULER_Utils::waitForEvent(idleTime);
+            return;
+        }
+        #ifdef BUTTON_PIN
+            BUTTON_Utils::prepareForLightSleep();
+        #endif
+        esp_sleep_enable_timer_wakeup((uint64_t)sleepTime * 1000);
+        esp_sleep_enable_gpio_wakeup();
+        if (gpsIsActive) {
+            uart_set_wakeup_threshold(GPS_UART, 3);
+            esp_sleep_enable_uart_wakeup(GPS_UART);
+        }
+        Serial.flush();
+
+        int64_t sleepStart = esp_timer_get_time();
+        esp_light_sleep_start();
+        lightSleepStats.sleepTime += esp_timer_get_time() - sleepStart;
+        lightSleepStats.sleeps++;
+
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+        #ifdef BUTTON_PIN
+            BUTTON_Utils::resumeFromLightSleep();
+        #endif
+        countWakeup(LoRa_Utils::resumeFromLightSleep());
+    }
+
+    LightSleepStats getLightSleepStats() {
+        return lightSleepStats;
+    }
+
+    uint8_t getSleepPercentage() {
+        int64_t upTime = esp_timer_get_time();
+        return (upTime > 0) ? (uint8_t)(lightSleepStats.sleepTime * 100 / upTime) : 0;
+    }
+
+    void logLightSleepStats() {
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Sleep", "Light sleep: %u%% of uptime, %u sleeps (wakeups radio: %u gps: %u button: %u timer: %u)",
+                    getSleepPercentage(), (unsigned int)lightSleepStats.sleeps, (unsigned int)lightSleepStats.radioWakeups,
+                    (unsigned int)lightSleepStats.gpsWakeups, (unsigned int)lightSleepStats.buttonWakeups, (unsigned int)lightSleepStats.timerWakeups);
+    }
+
 }
\ No newline at end of file
@@ -17,6 +17,7 @@
  */
 
 #include "smartbeacon_utils.h"
+#include "airtime_utils.h"
 #include "configuration.h"
 #include "winlink_utils.h"
 
@@ -60,13 +61,14 @@ namespace SMARTBEACON_Utils {
             } else {
                 txInterval = min(currentSmartBeaconValues.slowRate, currentSmartBeaconValues.fastSpeed * currentSmartBeaconValues.fastRate / speed) * 1000;
             }
+            txInterval *= AIRTIME_Utils::getBeaconBackoff();    // stretched while the channel share is running out
         }
     }
 
     void checkFixedBeaconTime() {
         if (!smartBeaconActive) {
             uint32_t lastTxSmartBeacon = millis() - lastTxTime;
-            if (lastTxSmartBeacon >= Config.nonSmartBeaconRate * 60 * 1000) sendUpdate = true;
+            if (lastTxSmartBeacon >= Config.nonSmartBeaconRate * 60 * 1000 * AIRTIME_Utils::getBeaconBackoff()) sendUpdate = true;
         }
     }
 
@@ -18,15 +18,18 @@
 
 #include <APRSPacketLib.h>
 #include <TinyGPS++.h>
-#include <SPIFFS.h>
 #include "telemetry_utils.h"
 #include "station_utils.h"
+#include "storage_utils.h"
+#include "gps_utils.h"
 #include "battery_utils.h"
+#include "beacon_utils.h"
 #include "configuration.h"
 #include "board_pinout.h"
 #include "power_utils.h"
 #include "sleep_utils.h"
 #include "lora_utils.h"
+#include "tx_utils.h"
 #include "ble_utils.h"
 #include "wx_utils.h"
 #include "display.h"
@@ -67,117 +70,231 @@ uint8_t     updateCounter           = 100;
 
 
 bool        sendStartTelemetry      = true;
+bool        firstBeaconSent         = false;
 
-uint32_t    lastDeleteListenedStation;
-const int   nearbyStationsSize  = 4;
+#define STATION_KEY_SIZE        7       // 6 callsign chars + SSID
+#define STATION_TABLE_SIZE      (2 * NEARBY_STATIONS_CAPACITY)     // hash slots, keeps probes short
+#define STATION_WHEEL_SLOTS     16      // expiry buckets over rememberStationTime
+#define STATION_NONE            0xFF
 
-
-struct nearStation {
-    String      callsign;
+struct NearStation {
+    uint8_t     key[STATION_KEY_SIZE];
+    float       latitude;
+    float       longitude;
     float       distance;
-    int         course;
+    int16_t     course;
     uint32_t    lastTime;
+    uint8_t     wheelNext;              // expiry bucket list
+    uint8_t     wheelPrev;
+    uint8_t     wheelSlot;
 };
 
-nearStation nearbyStations[nearbyStationsSize];
+NearStation nearbyStations[NEARBY_STATIONS_CAPACITY];
+uint8_t     stationSlots[STATION_TABLE_SIZE];                  // open addressing, index into nearbyStations[]
+uint8_t     distanceIndex[NEARBY_STATIONS_CAPACITY];           // nearbyStations[] ordered by distance
+uint8_t     nearbyStationsCount     = 0;
+uint8_t     freeStations[NEARBY_STATIONS_CAPACITY];
+uint8_t     freeStationsCount       = 0;
+uint8_t     stationWheel[STATION_WHEEL_SLOTS];
+uint32_t    stationWheelTick        = 0;
+uint32_t    stationWheelTickTime    = 60 * 1000;
 
 
 namespace STATION_Utils {
 
-    void nearStationInit() {
-        for (int i = 0; i < nearbyStationsSize; i++) {
-            nearbyStations[i].callsign    = "";
-            nearbyStations[i].distance    = 0.0;
-            nearbyStations[i].course      = 0;
-            nearbyStations[i].lastTime    = 0;
+    bool packCallsign(const String& callsign, uint8_t *key) {  // "CALL-SSID" -> 7 bytes
+        int dash = callsign.indexOf('-');
+        int baseLength = (dash < 0) ? callsign.length() : dash;
+        if (baseLength == 0 || baseLength > 6) return false;
+        for (int i = 0; i < 6; i++) key[i] = (i < baseLength) ? toupper(callsign[i]) : ' ';
+        int ssid = 0;
+        if (dash >= 0) {
+            int ssidLength = callsign.length() - dash - 1;
+            if (ssidLength < 1 || ssidLength > 2) return false;
+            for (int i = dash + 1; i < (int)callsign.length(); i++) {
+                if (!isDigit(callsign[i])) return false;
+                ssid = ssid * 10 + (callsign[i] - '0');
+            }
         }
+        key[6] = ssid;
+        return true;
     }
 
-    String getNearStation(uint8_t position) {
-        if (nearbyStations[position].callsign == "") return "";
-        return nearbyStations[position].callsign + "> " + String(nearbyStations[position].distance,2) + "km " + String(nearbyStations[position].course);
+    String unpackCallsign(const uint8_t *key) {
+        String callsign;
+        for (int i = 0; i < 6 && key[i] != ' '; i++) callsign += (char)key[i];
+        if (key[6] != 0) {
+            callsign += "-";
+            callsign += String(key[6]);
+        }
+        return callsign;
     }
 
-    void deleteListenedStationsByTime() {
-        for (int a = 0; a < nearbyStationsSize; a++) {                       // clean nearbyStations[] after time
-            if (nearbyStations[a].callsign != "" && (millis() - nearbyStations[a].lastTime > Config.rememberStationTime * 60 * 1000)) {
-                nearbyStations[a].callsign    = "";
-                nearbyStations[a].distance    = 0.0;
-                nearbyStations[a].course      = 0;
-                nearbyStations[a].lastTime    = 0;
-            }
+    uint8_t keyHash(const uint8_t *key) {
+        uint32_t hash = 2166136261;     // FNV-1a
+        for (int i = 0; i < STATION_KEY_SIZE; i++) {
+            hash ^= key[i];
+            hash *= 16777619;
         }
+        return hash % STATION_TABLE_SIZE;
+    }
 
-        for (int b = 0; b < nearbyStationsSize - 1; b++) {
-            for (int c = 0; c < nearbyStationsSize - b - 1; c++) {
-                if (nearbyStations[c].callsign == "") {       // get "" nearbyStations[] at the end
-                    nearStation temp    = nearbyStations[c];
-                    nearbyStations[c]     = nearbyStations[c + 1];
-                    nearbyStations[c + 1] = temp;
-                }
+    int findSlot(const uint8_t *key) {  // slot holding key, or the empty slot where it goes
+        int slot = keyHash(key);
+        while (stationSlots[slot] != STATION_NONE && memcmp(nearbyStations[stationSlots[slot]].key, key, STATION_KEY_SIZE) != 0) {
+            slot = (slot + 1) % STATION_TABLE_SIZE;
+        }
+        return slot;
+    }
+
+    void removeSlot(int slot) {         // backward shift, no tombstones
+        int next = (slot + 1) % STATION_TABLE_SIZE;
+        while (stationSlots[next] != STATION_NONE) {
+            int home = keyHash(nearbyStations[stationSlots[next]].key);
+            if ((next > slot && (home <= slot || home > next)) || (next < slot && (home <= slot && home > next))) {
+                stationSlots[slot] = stationSlots[next];
+                slot = next;
             }
+            next = (next + 1) % STATION_TABLE_SIZE;
         }
-        lastDeleteListenedStation = millis();
+        stationSlots[slot] = STATION_NONE;
     }
 
-    void checkListenedStationsByTimeAndDelete() {
-        if (millis() - lastDeleteListenedStation > Config.rememberStationTime * 60 * 1000) deleteListenedStationsByTime();
+    void wheelLink(uint8_t station) {
+        NearStation& entry  = nearbyStations[station];
+        entry.wheelSlot     = stationWheelTick % STATION_WHEEL_SLOTS;
+        entry.wheelPrev     = STATION_NONE;
+        entry.wheelNext     = stationWheel[entry.wheelSlot];
+        if (entry.wheelNext != STATION_NONE) nearbyStations[entry.wheelNext].wheelPrev = station;
+        stationWheel[entry.wheelSlot] = station;
     }
 
-    void orderListenedStationsByDistance(const String& callsign, float distance, float course) {
-        bool shouldSortbyDistance = false;
-        bool callsignInNearStations = false;
-
-        for (int a = 0; a < nearbyStationsSize; a++) {                       // check if callsign is in nearbyStations[]
-            if (nearbyStations[a].callsign == callsign) {
-                callsignInNearStations  = true;
-                nearbyStations[a].lastTime = millis();        // update listened millis()
-                if (nearbyStations[a].distance != distance) { // update distance if needed
-                    nearbyStations[a].distance    = distance;
-                    shouldSortbyDistance        = true;
-                }
-                break;
+    void wheelUnlink(uint8_t station) {
+        NearStation& entry = nearbyStations[station];
+        if (entry.wheelPrev != STATION_NONE) {
+            nearbyStations[entry.wheelPrev].wheelNext = entry.wheelNext;
+        } else {
+            stationWheel[entry.wheelSlot] = entry.wheelNext;
+        }
+        if (entry.wheelNext != STATION_NONE) nearbyStations[entry.wheelNext].wheelPrev = entry.wheelPrev;
+    }
+
+    void distanceIndexRemove(uint8_t station) {
+        for (int i = 0; i < nearbyStationsCount; i++) {
+            if (distanceIndex[i] == station) {
+                memmove(&distanceIndex[i], &distanceIndex[i + 1], nearbyStationsCount - i - 1);
+                nearbyStationsCount--;
+                return;
             }
         }
+    }
 
-        if (!callsignInNearStations) {                      // callsign not in nearbyStations[]
-            for (int b = 0; b < nearbyStationsSize; b++) {                   // if nearbyStations[] is available
-                if (nearbyStations[b].callsign == "") {
-                    shouldSortbyDistance        = true;
-                    nearbyStations[b].callsign    = callsign;
-                    nearbyStations[b].distance    = distance;
-                    nearbyStations[b].course      = int(course);
-                    nearbyStations[b].lastTime    = millis();
-                    break;
-                }
+    void distanceIndexInsert(uint8_t station) {
+        float distance = nearbyStations[station].distance;
+        int low = 0, high = nearbyStationsCount;
+        while (low < high) {
+            int middle = (low + high) / 2;
+            if (nearbyStations[distanceIndex[middle]].distance <= distance) {
+                low = middle + 1;
+            } else {
+                high = middle;
             }
+        }
+        memmove(&distanceIndex[low + 1], &distanceIndex[low], nearbyStationsCount - low);
+        distanceIndex[low] = station;
+        nearbyStationsCount++;
+    }
 
-            if (!shouldSortbyDistance) {                    // if no more nearbyStations[] available , it compares distances to move and replace
-                for (int c = 0; c < nearbyStationsSize; c++) {
-                    if (nearbyStations[c].distance > distance) {
-                        for (int d = nearbyStationsSize - 1; d > c; d--) nearbyStations[d] = nearbyStations[d - 1]; // move all one position down
-                        nearbyStations[c].callsign    = callsign;
-                        nearbyStations[c].distance    = distance;
-                        nearbyStations[c].course      = int(course);
-                        nearbyStations[c].lastTime    = millis();
-                        break;
-                    }
-                }
+    void removeStation(uint8_t station) {
+        removeSlot(findSlot(nearbyStations[station].key));
+        wheelUnlink(station);
+        distanceIndexRemove(station);
+        freeStations[freeStationsCount++] = station;
+    }
+
+    void nearStationInit() {
+        memset(stationSlots, STATION_NONE, sizeof(stationSlots));
+        memset(stationWheel, STATION_NONE, sizeof(stationWheel));
+        for (int i = 0; i < NEARBY_STATIONS_CAPACITY; i++) freeStations[i] = NEARBY_STATIONS_CAPACITY - 1 - i;
+        freeStationsCount       = NEARBY_STATIONS_CAPACITY;
+        nearbyStationsCount     = 0;
+        uint32_t rememberTime   = Config.rememberStationTime * 60 * 1000;
+        stationWheelTickTime    = max(rememberTime / (STATION_WHEEL_SLOTS - 1), (uint32_t)1000);
+        stationWheelTick        = millis() / stationWheelTickTime;
+    }
+
+    uint8_t getNearStationsCount() {
+        return nearbyStationsCount;
+    }
+
+    String getNearStation(uint8_t position) {   // top-k read of the distance index
+        if (position >= nearbyStationsCount) return "";
+        const NearStation& station = nearbyStations[distanceIndex[position]];
+        return unpackCallsign(station.key) + "> " + String(station.distance,2) + "km " + String(station.course);
+    }
+
+    void deleteListenedStationsByTime() {       // advance the wheel, a bucket expires as it comes round again
+        uint32_t currentTick = millis() / stationWheelTickTime;
+        for (int steps = 0; stationWheelTick != currentTick && steps < STATION_WHEEL_SLOTS; steps++) {
+            stationWheelTick++;
+            uint8_t slot = stationWheelTick % STATION_WHEEL_SLOTS;
+            while (stationWheel[slot] != STATION_NONE) removeStation(stationWheel[slot]);
+        }
+        stationWheelTick = currentTick;
+    }
+
+    void checkListenedStationsByTimeAndDelete() {
+        deleteListenedStationsByTime();
+    }
+
+    void orderListenedStationsByDistance(const String& callsign, float latitude, float longitude, float distance, float course) {
+        deleteListenedStationsByTime();     // wheel must be on the current tick before linking
+        uint8_t key[STATION_KEY_SIZE];
+        if (!packCallsign(callsign, key)) {
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Station", "Not listed (callsign format): %s", callsign.c_str());
+            return;
+        }
+        int slot = findSlot(key);
+        uint8_t station = stationSlots[slot];
+        if (station != STATION_NONE) {                      // heard again: refresh expiry and distance
+            wheelUnlink(station);
+            distanceIndexRemove(station);
+        } else {
+            if (freeStationsCount == 0) {                   // full: replace the farthest one if this one is closer
+                uint8_t farthest = distanceIndex[nearbyStationsCount - 1];
+                if (nearbyStations[farthest].distance <= distance) return;
+                removeStation(farthest);
+                slot = findSlot(key);
             }
+            station = freeStations[--freeStationsCount];
+            memcpy(nearbyStations[station].key, key, STATION_KEY_SIZE);
+            stationSlots[slot] = station;
         }
+        NearStation& entry  = nearbyStations[station];
+        entry.latitude      = latitude;
+        entry.longitude     = longitude;
+        entry.distance      = distance;
+        entry.course        = int(course);
+        entry.lastTime      = millis();
+        wheelLink(station);
+        distanceIndexInsert(station);
+    }
 
-        if (shouldSortbyDistance) { /*  BUBLE SORT  */      // sorts by distance (only nearbyStations[] that are not "")
-            for (int e = 0; e < nearbyStationsSize - 1; e++) {
-                for (int f = 0; f < nearbyStationsSize - e - 1; f++) {
-                    if (nearbyStations[f].callsign != "" && nearbyStations[f + 1].callsign != "") {
-                        if (nearbyStations[f].distance > nearbyStations[f + 1].distance) {
-                            nearStation temp        = nearbyStations[f];
-                            nearbyStations[f]       = nearbyStations[f + 1];
-                            nearbyStations[f + 1]   = temp;
-                        }
-                    }
-                }
+    void recalculateDistances() {       // own position moved: one pass, then re-sort the (mostly ordered) index
+        for (int i = 0; i < nearbyStationsCount; i++) {
+            NearStation& entry = nearbyStations[distanceIndex[i]];
+            float course;
+            GPS_Utils::getDistanceCourse(entry.latitude, entry.longitude, entry.distance, course);
+            entry.course = int(course);
+        }
+        for (int i = 1; i < nearbyStationsCount; i++) {     // insertion sort
+            uint8_t station = distanceIndex[i];
+            int j = i - 1;
+            while (j >= 0 && nearbyStations[distanceIndex[j]].distance > nearbyStations[station].distance) {
+                distanceIndex[j + 1] = distanceIndex[j];
+                j--;
             }
+            distanceIndex[j + 1] = station;
         }
     }
 
@@ -194,13 +311,11 @@ namespace STATION_Utils {
     void sendBeacon() {
         if (sendStartTelemetry && ((Config.battery.sendVoltage && Config.battery.voltageAsTelemetry) || (Config.telemetry.sendTelemetry && wxModuleFound)) && lastTxTime > 0) TELEMETRY_Utils::sendEquationsUnitsParameters();
 
-        String path = Config.path;
-        if (gps.speed.kmph() > 200 || gps.altitude.meters() > 9000) path = ""; // avoid plane speed and altitude
-        String packet;
+        bool withPath = !(gps.speed.kmph() > 200 || gps.altitude.meters() > 9000);  // avoid plane speed and altitude
         if (miceActive) {
-            packet = APRSPacketLib::generateMiceGPSBeaconPacket(currentBeacon->micE, currentBeacon->callsign, currentBeacon->symbol, currentBeacon->overlay, path, gps.location.lat(), gps.location.lng(), gps.course.deg(), gps.speed.knots(), gps.altitude.meters());
+            BEACON_Utils::startMicE(withPath);
         } else {
-            packet = APRSPacketLib::generateBase91GPSBeaconPacket(currentBeacon->callsign, "APLRT1", path, currentBeacon->overlay, APRSPacketLib::encodeGPSIntoBase91(gps.location.lat(),gps.location.lng(), gps.course.deg(), gps.speed.knots(), currentBeacon->symbol, Config.sendAltitude, gps.altitude.feet(), sendStandingUpdate));
+            BEACON_Utils::startPosition(withPath);
         }
 
         String batteryVoltage = BATTERY_Utils::getBatteryInfoVoltage();
@@ -210,48 +325,43 @@ namespace STATION_Utils {
         #endif
 
         if (!shouldSleepLowVoltage) {
-            String comment = (winlinkCommentState ? "winlink" : currentBeacon->comment);
+            const char* comment = (winlinkCommentState ? "winlink" : currentBeacon->comment.c_str());
             int sendCommentAfterXBeacons = ((winlinkCommentState || Config.battery.sendVoltageAlways) ? 1 : Config.sendCommentAfterXBeacons);
-
-            if (Config.battery.sendVoltage && !Config.battery.voltageAsTelemetry) {
-                #if defined(HAS_AXP192) || defined(HAS_AXP2101)
-                    String batteryChargeCurrent = POWER_Utils::getBatteryInfoCurrent();
-                    #if defined(HAS_AXP192)
-                        comment += " Bat=";
-                        comment += batteryVoltage;
-                        comment += "V (";
-                        comment += batteryChargeCurrent;
-                        comment += "mA)";
-                    #elif defined(HAS_AXP2101)
-                        comment += " Bat=";
-                        comment += String(batteryVoltage.toFloat(),2);
-                        comment += "V (";
-                        comment += batteryChargeCurrent;
-                        comment += "%)";
-                    #endif
-                #elif defined(BATTERY_PIN)
-                    comment += " Bat=";
-                    comment += String(batteryVoltage.toFloat(),2);
-                    comment += "V";
-                    comment += BATTERY_Utils::getPercentVoltageBattery(batteryVoltage.toFloat());
-                    comment += "%";
-                #endif
-            }
-
-            if (comment != "" || (Config.battery.sendVoltage && Config.battery.voltageAsTelemetry) || (Config.telemetry.sendTelemetry && wxModuleFound)) {
+            bool sendTelemetry = (Config.battery.sendVoltage && Config.battery.voltageAsTelemetry) || (Config.telemetry.sendTelemetry && wxModuleFound);
+            #if defined(BATTERY_PIN) || defined(HAS_AXP192) || defined(HAS_AXP2101)
+                bool sendBatteryComment = Config.battery.sendVoltage && !Config.battery.voltageAsTelemetry;
+            #else
+                bool sendBatteryComment = false;
+            #endif
+
+            if (comment[0] != '\0' || sendBatteryComment || sendTelemetry) {
                 updateCounter++;
                 if (updateCounter >= sendCommentAfterXBeacons) {
-                    if (comment != "") packet += comment;
-                    if ((Config.battery.sendVoltage && Config.battery.voltageAsTelemetry) || (Config.telemetry.sendTelemetry && wxModuleFound)) packet += TELEMETRY_Utils::generateEncodedTelemetry();
+                    BEACON_Utils::append(comment);
+                    if (sendBatteryComment) {
+                        #if defined(HAS_AXP192)
+                            BEACON_Utils::appendf(" Bat=%sV (%smA)", batteryVoltage.c_str(), POWER_Utils::getBatteryInfoCurrent().c_str());
+                        #elif defined(HAS_AXP2101)
+                            BEACON_Utils::appendf(" Bat=%.2fV (%s%%)", batteryVoltage.toFloat(), POWER_Utils::getBatteryInfoCurrent().c_str());
+                        #elif defined(BATTERY_PIN)
+                            BEACON_Utils::appendf(" Bat=%.2fV%s%%", batteryVoltage.toFloat(), BATTERY_Utils::getPercentVoltageBattery(batteryVoltage.toFloat()).c_str());
+                        #endif
+                    }
+                    if (sendTelemetry) BEACON_Utils::append(TELEMETRY_Utils::generateEncodedTelemetry());
                     updateCounter = 0;
                 }
             }
         } else {
-            packet += "**LowVoltagePowerOff**";
+            BEACON_Utils::append("**LowVoltagePowerOff**");
         }
+        String packet = BEACON_Utils::finish();
 
         displayShow("<<< TX >>>", "", packet, 100);
-        LoRa_Utils::sendNewPacket(packet);
+        TX_Utils::queuePacket(packet, TX_PRIORITY_BEACON);
+        if (!firstBeaconSent) {     // time-to-first-beacon, for boot time comparisons
+            firstBeaconSent = true;
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Boot", "First beacon %lu ms after boot", millis());
+        }
 
         if (Config.bluetooth.useBLE) BLE_Utils::sendToPhone(packet);   // send Tx packets to Phone too
 
@@ -268,42 +378,55 @@ namespace STATION_Utils {
         if (currentBeacon->gpsEcoMode) gpsShouldSleep = true;
     }
 
-    void saveIndex(uint8_t type, uint8_t index) {
-        String filePath;
+    // Indexes live in NVS; the old one-line text files are only read once to migrate them.
+    const char* indexKey(uint8_t type) {
         switch (type) {
-            case 0: filePath = "/callsignIndex.txt"; break;
-            case 1: filePath = "/freqIndex.txt"; break;
-            case 2: filePath = "/brightness.txt"; break;
-            default: return; // Invalid type, exit function
+            case 0: return "callsignIndex";
+            case 1: return "freqIndex";
+            case 2: return "brightness";
+            default: return nullptr;
         }
+    }
 
-        File fileIndex = SPIFFS.open(filePath, "w");
-        if (!fileIndex) return;
+    const char* indexLegacyPath(uint8_t type) {
+        switch (type) {
+            case 0: return "/callsignIndex.txt";
+            case 1: return "/freqIndex.txt";
+            case 2: return "/brightness.txt";
+            default: return nullptr;
+        }
+    }
 
-        String dataToSave = String(index);
-        if (fileIndex.println(dataToSave)) {
-            String logMessage;
-            switch (type) {
-                case 0: logMessage = "New Callsign Index"; break;
-                case 1: logMessage = "New Frequency Index"; break;
-                case 2: logMessage = "New Brightness"; break;
-                default: return; // Invalid type, exit function
-            }
-            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "%s saved to SPIFFS", logMessage.c_str());
+    void saveIndex(uint8_t type, uint8_t index) {
+        const char* key = indexKey(type);
+        if (key == nullptr) return; // Invalid type, exit function
+
+        STORAGE_Utils::setValue(key, index);
+        String logMessage;
+        switch (type) {
+            case 0: logMessage = "New Callsign Index"; break;
+            case 1: logMessage = "New Frequency Index"; break;
+            case 2: logMessage = "New Brightness"; break;
         }
-        fileIndex.close();
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "%s: %d", logMessage.c_str(), index);
     }
 
     void loadIndex(uint8_t type) {
-        String filePath;
-        switch (type) {
-            case 0: filePath = "/callsignIndex.txt"; break;
-            case 1: filePath = "/freqIndex.txt"; break;
-            case 2: filePath = "/brightness.txt"; break;
-            default: return; // Invalid type, exit function
+        const char* key = indexKey(type);
+        if (key == nullptr) return; // Invalid type, exit function
+
+        uint8_t index;
+        bool found = STORAGE_Utils::getValue(key, index);
+        if (!found && LittleFS.exists(indexLegacyPath(type))) {
+            File fileIndex = LittleFS.open(indexLegacyPath(type), "r");
+            index = fileIndex.readStringUntil('\n').toInt();
+            fileIndex.close();
+            LittleFS.remove(indexLegacyPath(type));
+            STORAGE_Utils::setValue(key, index);
+            found = true;
         }
 
-        if (!SPIFFS.exists(filePath)) {
+        if (!found) {
             switch (type) {
                 case 0: myBeaconsIndex = 0; break;
                 case 1: loraIndex = 0; break;
@@ -314,29 +437,22 @@ namespace STATION_Utils {
                         screenBrightness = 1;
                     #endif
                     break;
-                default: return; // Invalid type, exit function
             }
             return;
+        }
+
+        String logMessage;
+        if (type == 0) {
+            myBeaconsIndex = index;
+            logMessage = "Callsign Index:";
+        } else if (type == 1) {
+            loraIndex = index;
+            logMessage = "LoRa Freq Index:";
         } else {
-            File fileIndex = SPIFFS.open(filePath, "r");
-            while (fileIndex.available()) {
-                String firstLine = fileIndex.readStringUntil('\n');
-                int index = firstLine.toInt();
-                String logMessage;
-                if (type == 0) {
-                    myBeaconsIndex = index;
-                    logMessage = "Callsign Index:";
-                } else if (type == 1) {
-                    loraIndex = index;
-                    logMessage = "LoRa Freq Index:";
-                } else {
-                    screenBrightness = index;
-                    logMessage = "Brightness:";
-                }
-                logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "%s %s", logMessage.c_str(), firstLine);
-            }
-            fileIndex.close();
+            screenBrightness = index;
+            logMessage = "Brightness:";
         }
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Main", "%s %d", logMessage.c_str(), index);
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <Preferences.h>
+#include <SPIFFS.h>
+#include "storage_utils.h"
+#include "logger.h"
+
+extern logging::Logger  logger;
+
+
+struct PendingValue {
+    char        key[16];    // NVS keys are limited to 15 chars
+    uint8_t     value;
+};
+
+Preferences     preferences;
+bool            preferencesOpen     = false;
+
+uint8_t         migrateBuffer[STORAGE_MIGRATE_CHUNK];
+
+PendingValue    pendingValues[STORAGE_MAX_PENDING];
+uint8_t         pendingCount        = 0;
+uint32_t        lastValueChange     = 0;
+
+
+namespace STORAGE_Utils {
+
+    // Preferences can't be opened from the Configuration constructor (NVS isn't initialised
+    // before setup), so the namespace is opened on first use.
+    bool openPreferences() {
+        if (!preferencesOpen) preferencesOpen = preferences.begin("tracker", false);
+        return preferencesOpen;
+    }
+
+    // Copies one SPIFFS file into the migration namespace, STORAGE_MIGRATE_CHUNK bytes per
+    // blob. The file is only listed once all of its chunks are in.
+    bool stageFile(Preferences& migration, File& file, uint16_t index) {
+        char key[16];
+        uint16_t chunks = 0;
+        size_t length;
+        while ((length = file.read(migrateBuffer, sizeof(migrateBuffer))) > 0) {
+            snprintf(key, sizeof(key), "c%u.%u", index, chunks);
+            if (migration.putBytes(key, migrateBuffer, length) != length) break;
+            chunks++;
+        }
+        if (file.available() == 0) {
+            snprintf(key, sizeof(key), "p%u", index);
+            if (migration.putString(key, file.path()) > 0) return true;
+        }
+        for (uint16_t i = 0; i < chunks; i++) {
+            snprintf(key, sizeof(key), "c%u.%u", index, i);
+            migration.remove(key);
+        }
+        return false;
+    }
+
+    void restoreFile(Preferences& migration, uint16_t index) {
+        char key[16];
+        snprintf(key, sizeof(key), "p%u", index);
+        String path = migration.getString(key);
+        File target = LittleFS.open(path, FILE_WRITE);
+        bool written = (bool)target;
+        for (uint16_t chunk = 0; written; chunk++) {
+            snprintf(key, sizeof(key), "c%u.%u", index, chunk);
+            size_t length = migration.getBytes(key, migrateBuffer, sizeof(migrateBuffer));
+            if (length == 0) break;
+            written = target.write(migrateBuffer, length) == length;
+        }
+        if (!written) Serial.printf("Could not write %s\n", path.c_str());
+        target.close();
+    }
+
+    // One-time conversion of a partition still formatted as SPIFFS. Both share the partition,
+    // so the files are staged in NVS a chunk at a time before it is reformatted as LittleFS.
+    // The "staged" marker is set once SPIFFS has been read: a reset before it retries from
+    // SPIFFS, a reset after it formats again and restores from NVS, never losing the files.
+    bool migrateFromSPIFFS() {
+        Preferences migration;
+        if (!migration.begin("fsmigrate", false)) return false;
+        if (!migration.getBool("staged", false)) {
+            if (!SPIFFS.begin(false, "/spiffs", 10, STORAGE_PARTITION)) {
+                migration.end();
+                return false;
+            }
+            Serial.println("SPIFFS found, migrating to LittleFS...");
+            migration.clear();                          // left over from a staging cut short
+            uint16_t staged = 0;
+            File root = SPIFFS.open("/");
+            File file = root.openNextFile();
+            while (file) {
+                if (stageFile(migration, file, staged)) {
+                    staged++;
+                } else {
+                    Serial.printf("Could not stage %s, skipped\n", file.path());
+                }
+                file.close();
+                file = root.openNextFile();
+            }
+            root.close();
+            SPIFFS.end();
+            migration.putUShort("files", staged);
+            migration.putBool("staged", true);
+        } else {
+            Serial.println("Resuming SPIFFS to LittleFS migration...");
+        }
+
+        if (!LittleFS.begin(true, "/littlefs", 10, STORAGE_PARTITION)) {
+            migration.end();
+            return false;
+        }
+        uint16_t files = migration.getUShort("files", 0);
+        for (uint16_t i = 0; i < files; i++) restoreFile(migration, i);
+        migration.clear();
+        migration.end();
+        Serial.printf("%u files migrated to LittleFS\n", (unsigned int)files);
+        return true;
+    }
+
+    bool migrationStaged() {
+        Preferences migration;
+        if (!migration.begin("fsmigrate", true)) return false;    // no migration ever started
+        bool staged = migration.getBool("staged", false);
+        migration.end();
+        return staged;
+    }
+
+    bool mountFileSystem() {
+        if (!migrationStaged() && LittleFS.begin(false, "/littlefs", 10, STORAGE_PARTITION)) return true;
+        if (migrateFromSPIFFS()) return true;
+
+        Serial.println("LittleFS Mount Failed, formatting...");
+        return LittleFS.begin(true, "/littlefs", 10, STORAGE_PARTITION);
+    }
+
+    bool getValue(const char* key, uint8_t& value) {
+        for (uint8_t i = 0; i < pendingCount; i++) {
+            if (strcmp(pendingValues[i].key, key) == 0) {
+                value = pendingValues[i].value;
+                return true;
+            }
+        }
+        if (!openPreferences() || !preferences.isKey(key)) return false;
+        value = preferences.getUChar(key);
+        return true;
+    }
+
+    // Values are only kept in RAM here; repeated changes of the same key collapse into one
+    // entry and reach flash once the key has been left alone for STORAGE_WRITE_DELAY.
+    void setValue(const char* key, uint8_t value) {
+        lastValueChange = millis();
+        for (uint8_t i = 0; i < pendingCount; i++) {
+            if (strcmp(pendingValues[i].key, key) == 0) {
+                pendingValues[i].value = value;
+                return;
+            }
+        }
+        if (pendingCount == STORAGE_MAX_PENDING) flush(true);
+        if (pendingCount == STORAGE_MAX_PENDING) return;
+        strlcpy(pendingValues[pendingCount].key, key, sizeof(pendingValues[pendingCount].key));
+        pendingValues[pendingCount].value = value;
+        pendingCount++;
+    }
+
+    void flush(bool force) {
+        if (pendingCount == 0) return;
+        if (!force && millis() - lastValueChange < STORAGE_WRITE_DELAY) return;
+        if (!openPreferences()) return;
+
+        uint8_t written = 0;
+        for (uint8_t i = 0; i < pendingCount; i++) {
+            const PendingValue& pending = pendingValues[i];
+            if (preferences.isKey(pending.key) && preferences.getUChar(pending.key) == pending.value) continue;
+            if (preferences.putUChar(pending.key, pending.value) == 1) written++;
+        }
+        pendingCount = 0;
+        if (written > 0) logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "Storage", "%d setting(s) written to NVS", written);
+    }
+
+}
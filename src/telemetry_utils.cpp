@@ -24,6 +24,7 @@
 #include "station_utils.h"
 #include "battery_utils.h"
 #include "lora_utils.h"
+#include "tx_utils.h"
 #include "wx_utils.h"
 #include "display.h"
 
@@ -93,57 +94,30 @@ namespace TELEMETRY_Utils {
         String equationPacket = "EQNS." + joinWithCommas(getEquationCoefficients());
         String tempPacket = APRSPacketLib::generateMessagePacket(currentBeacon->callsign, "APLRT1", Config.path, currentBeacon->callsign, equationPacket);
         displayShow("<<< TX >>>", "Telemetry Packet:", "Equation Coefficients", 100);
-        LoRa_Utils::sendNewPacket(tempPacket);
+        TX_Utils::queuePacket(tempPacket, TX_PRIORITY_TELEMETRY);
     }
 
     void sendUnitLabels() {
         String unitPacket = "UNIT." + joinWithCommas(getUnitLabels());
         String tempPacket = APRSPacketLib::generateMessagePacket(currentBeacon->callsign, "APLRT1", Config.path, currentBeacon->callsign, unitPacket);
         displayShow("<<< TX >>>", "Telemetry Packet:", "Unit/Label", 100);
-        LoRa_Utils::sendNewPacket(tempPacket);
+        TX_Utils::queuePacket(tempPacket, TX_PRIORITY_TELEMETRY, 3000);
     }
 
     void sendParameterNames() {
         String parameterPacket = "PARM." + joinWithCommas(getParameterNames());
         String tempPacket = APRSPacketLib::generateMessagePacket(currentBeacon->callsign, "APLRT1", Config.path, currentBeacon->callsign, parameterPacket);
         displayShow("<<< TX >>>", "Telemetry Packet:", "Parameter Name",100);
-        LoRa_Utils::sendNewPacket(tempPacket);
+        TX_Utils::queuePacket(tempPacket, TX_PRIORITY_TELEMETRY, 6000);
     }
 
     void sendEquationsUnitsParameters() {
-        sendEquationCoefficients();
-        delay(3000);
+        sendEquationCoefficients();     // queued 3 s apart
         sendUnitLabels();
-        delay(3000);
         sendParameterNames();
-        delay(3000);
         sendStartTelemetry = false;
     }
 
-    String generateEncodedTelemetryBytes(float value, bool counterBytes, byte telemetryType) {
-        String encodedBytes;
-        int tempValue;
-
-        if (counterBytes) {
-            tempValue = value;
-        } else {
-            switch (telemetryType) {
-                case 0: tempValue = value * 100; break;         // Internal voltage (0-4,2V), Humidity, Gas calculation
-                case 1: tempValue = (value * 100) / 2; break;   // External voltage calculation (0-15V)
-                case 2: tempValue = (value * 10) + 500; break;  // Temperature
-                case 3: tempValue = (value * 8); break;         // Pressure
-                default: tempValue = value; break;
-            }
-        }
-
-        int firstByte   = tempValue / 91;
-        tempValue       -= firstByte * 91;
-
-        encodedBytes    = char(firstByte + 33);
-        encodedBytes    += char(tempValue + 33);
-        return encodedBytes;
-    }
-
     String generateEncodedTelemetry() {
         String telemetry = "|";
         telemetry += generateEncodedTelemetryBytes(telemetryCounter, true, 0);
@@ -0,0 +1,192 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "scheduler_utils.h"
+#include "packetlog_utils.h"
+#include "airtime_utils.h"
+#include "lora_utils.h"
+#include "tx_utils.h"
+#include "logger.h"
+
+extern logging::Logger  logger;
+extern LoraType         *currentLoRaType;
+
+
+struct TxEntry {
+    char        data[TX_PACKET_SIZE + 1];
+    uint16_t    length;
+    TxPriority  priority;
+    bool        used;
+    bool        selfGenerated;
+    bool        rateLimited;
+    uint8_t     backoffs;
+    uint32_t    readyTime;
+    uint32_t    sequence;
+};
+
+TxEntry     txQueue[TX_QUEUE_SIZE];
+uint32_t    txSequence      = 0;
+TxStats     txStats         = {0, 0, 0, 0};
+
+int32_t     txBudget        = TX_BUDGET_MAX;    // ms of airtime own packets may still use
+uint32_t    txBudgetTime    = 0;
+bool        txSelfGenerated = false;            // packet currently on air
+uint16_t    txLength        = 0;
+
+
+namespace TX_Utils {
+
+    // true if a should be sent before b
+    bool isBefore(const TxEntry& a, const TxEntry& b) {
+        if (a.priority != b.priority) return a.priority < b.priority;
+        return (int32_t)(a.sequence - b.sequence) < 0;
+    }
+
+    // Only the part of the elapsed time that was converted into budget is consumed, so frequent
+    // calls don't lose the remainder of the division.
+    void refillBudget() {
+        uint32_t elapsed = millis() - txBudgetTime;
+        int32_t gained = elapsed * TX_DUTY_CYCLE / 100;
+        if (gained == 0) return;
+        txBudgetTime += gained * 100 / TX_DUTY_CYCLE;
+        txBudget = min(txBudget + gained, (int32_t)TX_BUDGET_MAX);
+    }
+
+    bool queuePacket(const StringView& packet, TxPriority priority, uint32_t delayTime, bool selfGenerated) {
+        int slot = -1;
+        for (int i = 0; i < TX_QUEUE_SIZE; i++) {
+            if (!txQueue[i].used) {
+                slot = i;
+                break;
+            }
+            if (slot == -1 || isBefore(txQueue[slot], txQueue[i])) slot = i;   // last to be sent
+        }
+        if (txQueue[slot].used) {
+            txStats.dropped++;
+            if (txQueue[slot].priority <= priority) {
+                logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "TX", "Queue full, packet dropped");
+                return false;
+            }
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_WARN, "TX", "Queue full, dropped: %s", txQueue[slot].data);
+        }
+
+        TxEntry& entry      = txQueue[slot];
+        entry.length        = min(packet.length, (size_t)TX_PACKET_SIZE);
+        memcpy(entry.data, packet.data, entry.length);
+        entry.data[entry.length] = '\0';
+        entry.priority      = priority;
+        entry.used          = true;
+        entry.selfGenerated = selfGenerated;
+        entry.rateLimited   = false;
+        entry.backoffs      = 0;
+        entry.readyTime     = millis() + delayTime;
+        entry.sequence      = txSequence++;
+        SCHEDULER_Utils::signalEvent(EVENT_TX);
+        return true;
+    }
+
+    bool queuePacket(const String& packet, TxPriority priority, uint32_t delayTime, bool selfGenerated) {
+        StringView packetView = {packet.c_str(), packet.length()};
+        return queuePacket(packetView, priority, delayTime, selfGenerated);
+    }
+
+    // The budget is charged with the calculated time on air, so it matches the airtime
+    // accounting shown on the display and the web UI.
+    void transmitDone(uint32_t airtime, bool success) {
+        if (success) {
+            AIRTIME_Utils::recordTransmission(txLength);
+            if (txSelfGenerated) txBudget -= AIRTIME_Utils::getTimeOnAir(*currentLoRaType, txLength);
+            txStats.sent++;
+        } else if (txSelfGenerated) {
+            txBudget -= airtime;
+        }
+        if (!isIdle()) SCHEDULER_Utils::signalEvent(EVENT_TX);
+    }
+
+    void process() {
+        if (LoRa_Utils::isTransmitting()) {
+            LoRa_Utils::updateTransmit();
+            return;
+        }
+        refillBudget();
+        uint32_t now = millis();
+
+        TxEntry* next = nullptr;
+        for (int i = 0; i < TX_QUEUE_SIZE; i++) {
+            TxEntry& entry = txQueue[i];
+            if (!entry.used || (int32_t)(now - entry.readyTime) < 0) continue;
+            if (entry.selfGenerated && txBudget <= 0) {
+                if (!entry.rateLimited) txStats.rateLimited++;
+                entry.rateLimited = true;
+                continue;
+            }
+            if (next == nullptr || isBefore(entry, *next)) next = &entry;
+        }
+        if (next == nullptr) return;
+
+        // listen before talk: random backoff while other stations are transmitting
+        if (next->backoffs < TX_MAX_BACKOFFS && !LoRa_Utils::isChannelFree()) {
+            next->backoffs++;
+            next->readyTime = now + random(TX_BACKOFF_MIN, TX_BACKOFF_MAX * next->backoffs);
+            txStats.channelBusy++;
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_DEBUG, "TX", "Channel busy, backoff %u", next->backoffs);
+            return;
+        }
+
+        txSelfGenerated = next->selfGenerated;
+        txLength        = next->length + 3;     // "<\xff\x01" header added by LoRa_Utils
+        StringView packet = {next->data, next->length};
+        if (LoRa_Utils::startTransmit(packet, transmitDone)) {
+            PACKETLOG_Utils::addTransmitted(next->data, next->length);
+            next->used = false;
+        }
+    }
+
+    void flush() {              // before shutdown: send everything now, in priority order
+        for (;;) {
+            TxEntry* next = nullptr;
+            for (int i = 0; i < TX_QUEUE_SIZE; i++) {
+                if (txQueue[i].used && (next == nullptr || isBefore(txQueue[i], *next))) next = &txQueue[i];
+            }
+            if (next == nullptr) return;
+            StringView packet = {next->data, next->length};
+            LoRa_Utils::sendNewPacket(packet);
+            AIRTIME_Utils::recordTransmission(next->length + 3);
+            PACKETLOG_Utils::addTransmitted(next->data, next->length);
+            next->used = false;
+            txStats.sent++;
+        }
+    }
+
+    bool isIdle() {
+        for (int i = 0; i < TX_QUEUE_SIZE; i++) {
+            if (txQueue[i].used) return false;
+        }
+        return true;
+    }
+
+    TxStats getStats() {
+        return txStats;
+    }
+
+    void logStats() {
+        logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "TX", "sent: %u dropped: %u channel busy: %u rate limited: %u budget: %d ms",
+                    (unsigned int)txStats.sent, (unsigned int)txStats.dropped, (unsigned int)txStats.channelBusy, (unsigned int)txStats.rateLimited, (int)txBudget);
+    }
+
+}
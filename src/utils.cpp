@@ -22,6 +22,7 @@
 #include "configuration.h"
 #include "board_pinout.h"
 #include "lora_utils.h"
+#include "tx_utils.h"
 #include "display.h"
 #include "utils.h"
 
@@ -45,41 +46,11 @@ uint32_t    statusTime          = millis();
 uint8_t     wxModuleAddress     = 0x00;
 uint8_t     keyboardAddress     = 0x00;
 uint8_t     touchModuleAddress  = 0x00;
+uint32_t    heapReportTime      = 0;
 
 
 namespace Utils {
 
-    static char locator[11];    // letterize and getMaidenheadLocator functions are Copyright (c) 2021 Mateusz Salwach - MIT License
-
-    static char letterize(int x) {
-        return (char) x + 65;
-    }
-
-    char *getMaidenheadLocator(double lat, double lon, uint8_t size) {
-        double LON_F[]={20,2.0,0.083333,0.008333,0.0003472083333333333};
-        double LAT_F[]={10,1.0,0.0416665,0.004166,0.0001735833333333333};
-        int i;
-        lon += 180;
-        lat += 90;
-
-        if (size <= 0 || size > 10) size = 6;
-        size/=2; size*=2;
-
-        for (i = 0; i < size/2; i++) {
-            if (i % 2 == 1) {
-                locator[i*2] = (char) (lon/LON_F[i] + '0');
-                locator[i*2+1] = (char) (lat/LAT_F[i] + '0');
-            } else {
-                locator[i*2] = letterize((int) (lon/LON_F[i]));
-                locator[i*2+1] = letterize((int) (lat/LAT_F[i]));
-            }
-            lon = fmod(lon, LON_F[i]);
-            lat = fmod(lat, LAT_F[i]);
-        }
-        locator[i*2]=0;
-        return locator;
-    }
-
     static String padding(unsigned int number, unsigned int width) {
         String result;
         String num(number);
@@ -118,7 +89,7 @@ namespace Utils {
                 uint32_t statusTx = currentTime - statusTime;
                 lastTx = currentTime - lastTxTime;
                 if (statusTx > 10 * 60 * 1000 && lastTx > 10 * 1000) {
-                    LoRa_Utils::sendNewPacket(APRSPacketLib::generateStatusPacket(currentBeacon->callsign, "APLRT1", Config.path, currentBeacon->status));
+                    TX_Utils::queuePacket(APRSPacketLib::generateStatusPacket(currentBeacon->callsign, "APLRT1", Config.path, currentBeacon->status), TX_PRIORITY_BEACON);
                     statusUpdate = false;
                 }
             }
@@ -136,6 +107,17 @@ namespace Utils {
         }
     }
 
+    void checkHeapStatus() {       // low-water mark and fragmentation, to follow long uptimes
+        if (heapReportTime == 0 || millis() - heapReportTime >= 15 * 60 * 1000) {
+            uint32_t freeHeap       = ESP.getFreeHeap();
+            uint32_t largestBlock   = ESP.getMaxAllocHeap();
+            uint32_t fragmentation  = (freeHeap > 0) ? 100 - (largestBlock * 100 / freeHeap) : 0;
+            logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Heap", "Free: %u  Min Free: %u  Largest Block: %u  Fragmentation: %u%%",
+                (unsigned int)freeHeap, (unsigned int)ESP.getMinFreeHeap(), (unsigned int)largestBlock, (unsigned int)fragmentation);
+            heapReportTime = millis();
+        }
+    }
+
     String getSmartBeaconState() {
         if (currentBeacon->smartBeaconActive) return "On";
         return "Off";
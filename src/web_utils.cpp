@@ -17,12 +17,19 @@
  */
 
 #include <ArduinoJson.h>
+#include <esp_rom_crc.h>
+#include <memory>
 #include "configuration.h"
+#include "airtime_utils.h"
+#include "packetlog_utils.h"
+#include "station_utils.h"
+#include "power_utils.h"
 #include "web_utils.h"
 #include "display.h"
 #include "utils.h"
 
 extern Configuration               Config;
+extern uint8_t                     loraIndex;
 
 extern const char web_index_html[] asm("_binary_data_embed_index_html_gz_start");
 extern const char web_index_html_end[] asm("_binary_data_embed_index_html_gz_end");
@@ -49,6 +56,26 @@ extern const unsigned char favicon_data[] asm("_binary_data_embed_favicon_png_gz
 extern const unsigned char favicon_data_end[] asm("_binary_data_embed_favicon_png_gz_end");
 extern const size_t favicon_data_len = favicon_data_end - favicon_data;
 
+String  configurationView   = "";   // live Config as served to the page, built when the server starts
+String  configurationETag   = "";
+
+// WebConf runs early in setup(), so the new configuration is mostly picked up by the rest of the
+// boot. These hooks redo what was already set up from the old one. Bluetooth changes still reboot.
+struct ConfigApplyHook {
+    uint16_t    sections;
+    void        (*apply)();
+};
+
+const ConfigApplyHook configApplyHooks[] = {
+    {CONFIG_DISPLAY,    displayReconfigure},
+    {CONFIG_OTHER,      STATION_Utils::nearStationInit},    // expiry wheel follows rememberStationTime
+    {CONFIG_PINS,       POWER_Utils::externalPinSetup}
+};
+
+volatile bool       configurationSaved  = false;    // set by the web handler, applied by the main task
+volatile uint16_t   appliedSections     = 0;
+
+
 namespace WEB_Utils {
 
     AsyncWebServer server(80);
@@ -76,30 +103,86 @@ namespace WEB_Utils {
         request->send(response);
     }
 
-    void handleReadConfiguration(AsyncWebServerRequest *request) {
+    void buildConfigurationView() {
+        JsonDocument data;
+        Config.toJson(data);
+        configurationView = "";
+        serializeJson(data, configurationView);
+
+        char etag[12];
+        snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)esp_rom_crc32_le(0, (const uint8_t*)configurationView.c_str(), configurationView.length()));
+        configurationETag = etag;
+    }
 
-        File file = SPIFFS.open("/tracker_conf.json");
+    // Served from the precomputed view without touching flash; the file is only streamed
+    // if the view couldn't be built.
+    void handleReadConfiguration(AsyncWebServerRequest *request) {
+        const AsyncWebHeader* ifNoneMatch = request->getHeader("If-None-Match");
+        if (!configurationView.isEmpty() && ifNoneMatch != nullptr && ifNoneMatch->value() == configurationETag) {
+            AsyncWebServerResponse *response = request->beginResponse(304);
+            response->addHeader("ETag", configurationETag);
+            request->send(response);
+            return;
+        }
 
-        String fileContent;
-        while(file.available()){
-            fileContent += String((char)file.read());
+        AsyncWebServerResponse *response;
+        if (configurationView.isEmpty()) {
+            response = request->beginResponse(LittleFS, "/tracker_conf.json", "application/json");
+        } else {
+            response = request->beginResponse(200, "application/json", (const uint8_t*)configurationView.c_str(), configurationView.length());
+            response->addHeader("ETag", configurationETag);
         }
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+    }
 
-        request->send(200, "application/json", fileContent);
+    // Streams the packet log in chunks, so it never has to fit in RAM as a whole.
+    void sendPacketLog(AsyncWebServerRequest *request, PacketLogFormat format) {
+        std::shared_ptr<PacketLogCursor> cursor = std::make_shared<PacketLogCursor>();
+        String sender = request->hasParam("sender") ? request->getParam("sender")->value() : "";
+        PACKETLOG_Utils::openCursor(*cursor, format, sender);
+
+        AsyncWebServerResponse *response = request->beginChunkedResponse((format == PACKETLOG_JSON) ? "application/json" : "text/csv",
+            [cursor](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                return PACKETLOG_Utils::readChunk(*cursor, buffer, maxLen);
+            });
+        if (format == PACKETLOG_CSV) response->addHeader("Content-Disposition", "attachment; filename=received-packets.csv");
+        request->send(response);
     }
 
     void handleReceivedPackets(AsyncWebServerRequest *request) {
+        sendPacketLog(request, PACKETLOG_JSON);
+    }
+
+    void handleReceivedPacketsCSV(AsyncWebServerRequest *request) {
+        sendPacketLog(request, PACKETLOG_CSV);
+    }
+
+    void handleAirtime(AsyncWebServerRequest *request) {
         JsonDocument data;
+        data["current"] = loraIndex;
+
+        JsonArray profiles = data["profiles"].to<JsonArray>();
+        for (uint8_t i = 0; i < Config.loraTypes.size() && i < AIRTIME_MAX_PROFILES; i++) {
+            AirtimeUsage usage = AIRTIME_Utils::getUsage(i);
+            JsonObject profile      = profiles.add<JsonObject>();
+            profile["frequency"]    = Config.loraTypes[i].frequency;
+            profile["limit"]        = usage.limit / 10.0;
+            profile["lastMinute"]   = usage.lastMinute;
+            profile["last10Minutes"] = usage.last10Minutes;
+            profile["lastHour"]     = usage.lastHour;
+            profile["packets"]      = usage.packets;
+            profile["load"]         = usage.load;
+        }
 
         String buffer;
-
         serializeJson(data, buffer);
-
         request->send(200, "application/json", buffer);
     }
 
     void handleWriteConfiguration(AsyncWebServerRequest *request) {
         Serial.println("Got new config from www");
+        Configuration previous = Config;
 
         auto getParamStringSafe = [&](const String& name, const String& defaultValue = "") -> String {
             if (request->hasParam(name, true)) {
@@ -169,10 +252,12 @@ namespace WEB_Utils {
         Config.sendCommentAfterXBeacons         = getParamIntSafe("sendCommentAfterXBeacons", Config.sendCommentAfterXBeacons);
         Config.nonSmartBeaconRate               = getParamIntSafe("nonSmartBeaconRate", Config.nonSmartBeaconRate);
         Config.standingUpdateTime               = getParamIntSafe("standingUpdateTime", Config.standingUpdateTime);
+        Config.dedupTime                        = getParamIntSafe("dedupTime", Config.dedupTime);
         Config.email                            = getParamStringSafe("email", Config.email);
         Config.rememberStationTime              = getParamIntSafe("rememberStationTime", Config.rememberStationTime);
         Config.sendAltitude                     = request->hasParam("sendAltitude", true);
         Config.disableGPS                       = request->hasParam("disableGPS", true);
+        Config.packetLog                        = request->hasParam("packetLog", true);
         Config.simplifiedTrackerMode            = request->hasParam("simplifiedTrackerMode", true);
 
         //  Display
@@ -250,18 +335,29 @@ namespace WEB_Utils {
             Config.ptt.postDelay                = getParamIntSafe("ptt.postDelay", Config.ptt.postDelay);
         }
 
-        bool saveSuccess = Config.writeFile();
+        uint16_t changed = Config.changedSections(previous);
+        bool saveSuccess = (changed == 0) || Config.writeFile();
 
         if (saveSuccess) {
-            Serial.println("Configuration saved successfully");
+            if (changed == 0) {
+                Serial.println("Configuration unchanged, nothing written");
+            } else {
+                Serial.printf("Configuration saved successfully (sections 0x%03x)\n", (unsigned int)changed);
+            }
             AsyncWebServerResponse *response = request->beginResponse(302, "text/html", "");
             response->addHeader("Location", "/?success=1");
             request->send(response);
 
-            displayToggle(false);
-            delay(500);
-            ESP.restart();
+            if (changed & CONFIG_BLUETOOTH) {
+                displayToggle(false);
+                delay(500);
+                ESP.restart();
+            }
+            if (changed & CONFIG_PINS) POWER_Utils::externalPinRelease(previous);
+            appliedSections     = changed;
+            configurationSaved  = true;
         } else {
+            Config = previous;
             Serial.println("Error saving configuration!");
             String errorPage = "<!DOCTYPE html><html><head><title>Error</title></head><body>";
             errorPage += "<h1>Configuration Error:</h1>";
@@ -273,6 +369,18 @@ namespace WEB_Utils {
         }
     }
 
+    // Called from the WebConf loop: runs the hooks of the changed sections on the main task and
+    // stops the server, so the boot can go on with the new configuration.
+    bool applyConfiguration() {
+        if (!configurationSaved) return false;
+        delay(500);     // let the redirect reach the browser
+        server.end();
+        for (const ConfigApplyHook& hook : configApplyHooks) {
+            if (hook.sections & appliedSections) hook.apply();
+        }
+        return true;
+    }
+
     void handleAction(AsyncWebServerRequest *request) {
         String type = request->getParam("type", false)->value();
 
@@ -315,11 +423,15 @@ namespace WEB_Utils {
     }
 
     void setup() {
+        buildConfigurationView();
+
         server.on("/", HTTP_GET, handleHome);
         server.on("/status", HTTP_GET, handleStatus);
-        //server.on("/received-packets.json", HTTP_GET, handleReceivedPackets);
+        server.on("/received-packets.json", HTTP_GET, handleReceivedPackets);
+        server.on("/received-packets.csv", HTTP_GET, handleReceivedPacketsCSV);
         server.on("/configuration.json", HTTP_GET, handleReadConfiguration);
         server.on("/configuration.json", HTTP_POST, handleWriteConfiguration);
+        server.on("/airtime.json", HTTP_GET, handleAirtime);
         server.on("/action", HTTP_POST, handleAction);
         server.on("/style.css", HTTP_GET, handleStyle);
         server.on("/script.js", HTTP_GET, handleScript);
@@ -43,6 +43,13 @@ namespace WIFI_Utils {
             startAutoAP();
             WEB_Utils::setup();
             while (true) {
+                if (WEB_Utils::applyConfiguration()) {
+                    logger.log(logging::LoggerLevel::LOGGER_LEVEL_INFO, "Main", "WebConfiguration applied without reboot");
+                    displayShow("", "", "  STOPPING WiFi AP", 1000);
+                    WiFi.softAPdisconnect(true);
+                    WiFi.mode(WIFI_OFF);
+                    return;
+                }
                 if (WiFi.softAPgetStationNum() > 0) {
                     noClientsTime = 0;
                 } else {
@@ -54,6 +61,7 @@ namespace WIFI_Utils {
                         Config.wifiAP.active = false;
                         Config.writeFile();
                         WiFi.softAPdisconnect(true);
+                        delay(2000);
                         ESP.restart();
                     }
                 }
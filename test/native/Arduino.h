@@ -0,0 +1,149 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Host stand-in for the parts of the Arduino core the protocol code uses. Only what the native
+// test environment builds is covered; String mirrors the Arduino API on top of std::string.
+
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+typedef uint8_t byte;
+
+using std::min;
+using std::max;
+
+inline uint32_t millis() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline uint32_t micros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline void delay(uint32_t) {}
+
+#if defined(__GLIBC__) && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)     // newlib and newer glibc have it
+inline size_t strlcpy(char* destination, const char* source, size_t size) {
+    size_t length = strlen(source);
+    if (size > 0) {
+        size_t copied = min(length, size - 1);
+        memcpy(destination, source, copied);
+        destination[copied] = '\0';
+    }
+    return length;
+}
+#endif
+
+
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const char* text, unsigned int length) : value(text, length) {}
+    String(const std::string& text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(int number) : value(std::to_string(number)) {}
+    explicit String(unsigned int number) : value(std::to_string(number)) {}
+    explicit String(long number) : value(std::to_string(number)) {}
+    explicit String(unsigned long number) : value(std::to_string(number)) {}
+    explicit String(float number, unsigned int decimals = 2) : String((double)number, decimals) {}
+    explicit String(double number, unsigned int decimals = 2) {
+        char buffer[40];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, number);
+        value = buffer;
+    }
+
+    unsigned int    length() const                  { return value.length(); }
+    const char*     c_str() const                   { return value.c_str(); }
+    bool            isEmpty() const                 { return value.empty(); }
+    bool            reserve(unsigned int size)      { value.reserve(size); return true; }
+
+    String& operator=(const char* text)             { value = text ? text : ""; return *this; }
+    String& operator=(char c)                       { value.assign(1, c); return *this; }
+    String& operator+=(const String& other)         { value += other.value; return *this; }
+    String& operator+=(const char* text)            { value += text; return *this; }
+    String& operator+=(char c)                      { value += c; return *this; }
+    String& operator+=(int number)                  { value += std::to_string(number); return *this; }
+    bool    concat(const String& other)             { value += other.value; return true; }
+    bool    concat(const char* text)                { value += text; return true; }
+    bool    concat(char c)                          { value += c; return true; }
+
+    char    operator[](unsigned int index) const    { return index < value.length() ? value[index] : 0; }
+    char&   operator[](unsigned int index)          { return value[index]; }
+    char    charAt(unsigned int index) const        { return (*this)[index]; }
+    void    setCharAt(unsigned int index, char c)   { if (index < value.length()) value[index] = c; }
+
+    bool operator==(const String& other) const      { return value == other.value; }
+    bool operator==(const char* text) const         { return value == text; }
+    bool operator!=(const String& other) const      { return value != other.value; }
+    bool operator!=(const char* text) const         { return value != text; }
+    bool operator<(const String& other) const       { return value < other.value; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t position = value.find(c, from);
+        return position == std::string::npos ? -1 : (int)position;
+    }
+    int indexOf(const String& text, unsigned int from = 0) const {
+        size_t position = value.find(text.value, from);
+        return position == std::string::npos ? -1 : (int)position;
+    }
+    bool startsWith(const String& prefix) const     { return value.compare(0, prefix.value.length(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const {
+        return value.length() >= suffix.value.length() && value.compare(value.length() - suffix.value.length(), suffix.value.length(), suffix.value) == 0;
+    }
+    String substring(unsigned int from) const       { return from < value.length() ? String(value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= value.length()) return String();
+        return String(value.substr(from, std::min((size_t)to, value.length()) - from));
+    }
+
+    void trim() {
+        size_t first = value.find_first_not_of(" \t\r\n");
+        size_t last  = value.find_last_not_of(" \t\r\n");
+        value = (first == std::string::npos) ? std::string() : value.substr(first, last - first + 1);
+    }
+    void toUpperCase()                              { for (char& c : value) c = toupper((unsigned char)c); }
+    void toLowerCase()                              { for (char& c : value) c = tolower((unsigned char)c); }
+    long toInt() const                              { return atol(value.c_str()); }
+    float toFloat() const                           { return atof(value.c_str()); }
+    double toDouble() const                         { return atof(value.c_str()); }
+
+    friend String operator+(const String& left, const String& right)   { String result(left); result += right; return result; }
+    friend String operator+(const String& left, const char* right)     { String result(left); result += right; return result; }
+    friend String operator+(const char* left, const String& right)     { String result(left); result += right; return result; }
+    friend String operator+(const String& left, char right)            { String result(left); result += right; return result; }
+    friend String operator+(char left, const String& right)            { String result(left); result += right; return result; }
+
+private:
+    std::string value;
+};
+
+#endif
@@ -0,0 +1,113 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Host stand-in for the Arduino FS API, backed by files held in memory. Files are shared
+// between handles like on flash, so a store reopened in a test sees what was written before.
+
+#ifndef FS_H_
+#define FS_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Arduino.h"
+
+#define FILE_READ       "r"
+#define FILE_WRITE      "w"
+#define FILE_APPEND     "a"
+
+namespace fs {
+
+    typedef std::shared_ptr<std::vector<uint8_t>> FileData;
+
+    class File {
+    public:
+        File() {}
+        File(const FileData& data, bool writable, size_t position) : data(data), writable(writable), position(position) {}
+
+        explicit operator bool() const  { return data != nullptr; }
+        size_t  size() const            { return data ? data->size() : 0; }
+        int     available() const       { return data ? (int)(data->size() - position) : 0; }
+        void    flush() {}
+        void    close()                 { data.reset(); }
+
+        bool seek(size_t offset) {
+            if (!data || offset > data->size()) return false;
+            position = offset;
+            return true;
+        }
+
+        size_t read(uint8_t* buffer, size_t length) {
+            if (!data) return 0;
+            length = std::min(length, data->size() - position);
+            memcpy(buffer, data->data() + position, length);
+            position += length;
+            return length;
+        }
+
+        size_t write(const uint8_t* buffer, size_t length) {
+            if (!data || !writable) return 0;
+            if (position + length > data->size()) data->resize(position + length);
+            memcpy(data->data() + position, buffer, length);
+            position += length;
+            return length;
+        }
+
+        String readStringUntil(char terminator) {
+            String line;
+            while (data && position < data->size()) {
+                char c = (char)(*data)[position++];
+                if (c == terminator) break;
+                line += c;
+            }
+            return line;
+        }
+
+    private:
+        FileData    data;
+        bool        writable    = false;
+        size_t      position    = 0;
+    };
+
+    class FS {
+    public:
+        File open(const String& path, const char* mode = FILE_READ) {
+            auto file = files.find(path.c_str());
+            if (mode[0] == 'w' || (mode[0] == 'a' && file == files.end())) {
+                FileData data = std::make_shared<std::vector<uint8_t>>();
+                files[path.c_str()] = data;
+                return File(data, true, 0);
+            }
+            if (file == files.end()) return File();
+            return File(file->second, mode[0] == 'a' || mode[1] == '+', mode[0] == 'a' ? file->second->size() : 0);
+        }
+
+        bool exists(const String& path) const   { return files.count(path.c_str()) > 0; }
+        bool remove(const String& path)         { return files.erase(path.c_str()) > 0; }
+        void format()                           { files.clear(); }
+
+    private:
+        std::map<std::string, FileData> files;
+    };
+
+}
+
+using fs::File;
+using fs::FS;
+
+#endif
@@ -0,0 +1,43 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Host stand-in for esp-logger: messages are dropped, the tests check results instead.
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+namespace logging {
+
+    enum class LoggerLevel {
+        LOGGER_LEVEL_ERROR,
+        LOGGER_LEVEL_WARN,
+        LOGGER_LEVEL_INFO,
+        LOGGER_LEVEL_DEBUG
+    };
+
+    class Logger {
+    public:
+        void setDebugLevel(LoggerLevel) {}
+        void log(LoggerLevel, const char*, const char*, ...) {}
+    };
+
+}
+
+inline logging::Logger logger;
+
+#endif
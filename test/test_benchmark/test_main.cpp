@@ -0,0 +1,572 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Micro-benchmarks of the per-packet codecs: time and heap allocations per call. The buffer
+// codecs must not allocate at all, a change that makes them do so fails here. The KISS codec
+// is also compared with the String-based one it replaced, over a few real TNC2 lines, as are the
+// beacon assembly and the received message dispatch, and the equirectangular distance with
+// haversine, against a double-precision reference.
+
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "telemetry_utils.h"
+#include "msgbuffer_utils.h"
+#include "beacon_utils.h"
+#include "kiss_utils.h"
+#include "gps_utils.h"
+#include "utils.h"
+
+#define BENCHMARK_ITERATIONS    100000
+#define DISTANCE_PAIRS          1000
+
+
+std::atomic<uint32_t>   allocations(0);
+
+void* operator new(size_t size) {
+    allocations++;
+    void* pointer = malloc(size);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+struct BenchmarkResult {
+    double      nsPerOp;
+    uint32_t    allocations;    // over all iterations
+};
+
+volatile int    benchmarkSink   = 0;    // keeps the measured calls from being optimised away
+
+template<typename T> BenchmarkResult benchmark(const char* name, T operation) {
+    operation();                        // warm-up, lazily built statics aren't counted
+    uint32_t allocationsStart = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) operation();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    BenchmarkResult result;
+    result.nsPerOp          = (double)elapsed / BENCHMARK_ITERATIONS;
+    result.allocations      = allocations - allocationsStart;
+    printf("%-32s %10.1f ns/op %8.2f allocs/op\n", name, result.nsPerOp, (double)result.allocations / BENCHMARK_ITERATIONS);
+    return result;
+}
+
+namespace Legacy {      // KISS_Utils before the buffer codec, kept as the comparison baseline
+
+    bool validateKISSFrame(const String& kissFormattedFrame) {
+        return kissFormattedFrame.charAt(0) == (char)KissChar::FEND && kissFormattedFrame.charAt(kissFormattedFrame.length() - 1) == (char)KissChar::FEND;
+    }
+
+    String decodeAddressAX25(const String& ax25Address, bool& isLastAddress, bool isRelay) {
+        String address = "";
+        for (int i = 0; i < 6; ++i) {
+            uint8_t currentCharacter = ax25Address.charAt(i);
+            currentCharacter >>= 1;
+            if (currentCharacter != ' ') address += (char)currentCharacter;
+        }
+        auto ssidChar           = (uint8_t)ax25Address.charAt(6);
+        bool hasBeenDigipited   = ssidChar & HAS_BEEN_DIGIPITED_MASK;
+        isLastAddress           = ssidChar & IS_LAST_ADDRESS_POSITION_MASK;
+        ssidChar >>= 1;
+
+        int ssid = 0b1111 & ssidChar;
+        if (ssid) {
+            address += '-';
+            address += ssid;
+        }
+        if (isRelay && hasBeenDigipited) address += '*';
+        return address;
+    }
+
+    String decapsulateKISS(const String& frame) {
+        String ax25Frame = "";
+        for (int i = 2; i < frame.length() - 1; ++i) {
+            char currentChar = frame.charAt(i);
+            if (currentChar == (char)KissChar::FESC) {
+                char nextChar = frame.charAt(i + 1);
+                if (nextChar == (char)KissChar::TFEND) {
+                    ax25Frame += (char)KissChar::FEND;
+                } else if (nextChar == (char)KissChar::TFESC) {
+                    ax25Frame += (char)KissChar::FESC;
+                }
+                i++;
+            } else {
+                ax25Frame += currentChar;
+            }
+        }
+        return ax25Frame;
+    }
+
+    String encapsulateKISS(const String& ax25Frame, uint8_t command) {
+        String kissFrame = "";
+        kissFrame += (char)KissChar::FEND;
+        kissFrame += (char)(0x0f & command);
+
+        for (int i = 0; i < ax25Frame.length(); ++i) {
+            char currentChar = ax25Frame.charAt(i);
+            if (currentChar == (char)KissChar::FEND) {
+                kissFrame += (char)KissChar::FESC;
+                kissFrame += (char)KissChar::TFEND;
+            } else if (currentChar == (char)KissChar::FESC) {
+                kissFrame += (char)KissChar::FESC;
+                kissFrame += (char)KissChar::TFESC;
+            } else {
+                kissFrame += currentChar;
+            }
+        }
+        kissFrame += (char)KissChar::FEND; // end of frame
+        return kissFrame;
+    }
+
+    String encodeAddressAX25(String address) {
+        bool hasBeenDigipited = address.indexOf('*') != -1;
+        if (address.indexOf('-') == -1) {
+            if (hasBeenDigipited) address = address.substring(0, address.length() - 1);
+            address += "-0";
+        }
+
+        int separatorIndex  = address.indexOf('-');
+        int ssid            = address.substring(separatorIndex + 1).toInt();
+        String kissAddress  = "";
+        for (int i = 0; i < 6; ++i) {
+            char addressChar = ' ';
+            if (address.length() > i && i < separatorIndex) addressChar = address.charAt(i);
+            kissAddress += (char)(addressChar << 1);
+        }
+        kissAddress += (char)((ssid << 1) | 0b01100000 | (hasBeenDigipited ? HAS_BEEN_DIGIPITED_MASK : 0));
+        return kissAddress;
+    }
+
+    String decodeKISS(const String& inputFrame, bool& dataFrame) {
+        String frame = "";
+        if (validateKISSFrame(inputFrame)) {
+            dataFrame = inputFrame.charAt(1) == KissCmd::Data;
+            if (dataFrame) {
+                String ax25Frame    = decapsulateKISS(inputFrame);
+                bool isLastAddress         = false;
+                String dstAddr      = decodeAddressAX25(ax25Frame.substring(0, 7), isLastAddress, false);
+                String srcAddr      = decodeAddressAX25(ax25Frame.substring(7, 14), isLastAddress, false);
+
+                frame = srcAddr + ">" + dstAddr;
+
+                int digiInfoIndex = 14;
+                while (!isLastAddress && digiInfoIndex + 7 < ax25Frame.length()) {
+                    String digiAddr = decodeAddressAX25(ax25Frame.substring(digiInfoIndex, digiInfoIndex + 7), isLastAddress, true);
+                    frame += ',' + digiAddr;
+                    digiInfoIndex += 7;
+                }
+                frame += ':';
+                frame += ax25Frame.substring(digiInfoIndex + 2);
+            } else {
+                frame += inputFrame;
+            }
+        }
+        return frame;
+    }
+
+    String encodeKISS(const String& frame) {
+        String ax25Frame = "";
+
+        if (KISS_Utils::validateTNC2Frame(frame)) {
+            int colonIndex = frame.indexOf(':');
+
+            String address = "";
+            bool destinationAddressWritten = false;
+            for (int i = 0; i <= colonIndex; i++) {
+                char currentChar = frame.charAt(i);
+                if (currentChar == ':' || currentChar == '>' || currentChar == ',') {
+                    if (!destinationAddressWritten && (currentChar == ',' || currentChar == ':')) {
+                        ax25Frame = encodeAddressAX25(address) + ax25Frame;
+                        destinationAddressWritten = true;
+                    } else {
+                        ax25Frame += encodeAddressAX25(address);
+                    }
+                    address = "";
+                } else {
+                    address += currentChar;
+                }
+            }
+            auto lastAddressChar = (uint8_t)ax25Frame.charAt(ax25Frame.length() - 1);
+            ax25Frame.setCharAt(ax25Frame.length() - 1, (char)(lastAddressChar | IS_LAST_ADDRESS_POSITION_MASK));
+            ax25Frame += (char)AX25Char::ControlField;
+            ax25Frame += (char)AX25Char::InformationField;
+            ax25Frame += frame.substring(colonIndex + 1);
+        }
+        String kissFrame = encapsulateKISS(ax25Frame, KissCmd::Data);
+        return kissFrame;
+    }
+
+}
+
+const char  tnc2Frame[]     = "CA2RXU-7>APLRT1,WIDE1-1,WIDE2-1:!/6A4:Nq9a>Q2Bk LoRa APRS Tracker";
+uint8_t     kissFrame[KISS_MAX_ENCODED_FRAME];
+int         kissFrameLength = 0;
+
+const char* corpus[] = {
+    "CA2RXU-7>APLRT1,WIDE1-1:!/6A4:Nq9a>Q2Bk LoRa APRS Tracker",
+    "CD2RXU-11>APLRG1,WIDE1-1,WIDE2-1:=/5L!!<*e7>7P[Rx LoRa iGate",
+    "LU7DZ-9>T2SP0W,WIDE1-1*,WIDE2-1:`(_fn\"Oj/]\"4-}=",
+    "CA2RXU-15>APLRT1::CA2RXU-7 :WX 21.5C 63% 1013hPa{12",
+    "EA4GKQ-10>APRX29,WIDE2-2:;434.500-R*111111z4027.63N/00345.13WrT123 R20k",
+    "WLNK-1>APWLK,WIDE1-1::CA2RXU-7 :Login [482] ok"
+};
+const int   corpusSize  = sizeof(corpus) / sizeof(corpus[0]);
+String      legacyKissCorpus[corpusSize];
+
+// A Base91 beacon with comment and battery, as sendBeacon() builds it. The position is what
+// APRSPacketLib::encodeGPSIntoBase91() returns, a String in both cases.
+const char* beaconCallsign  = "CA2RXU-7";
+const char* beaconPath      = "WIDE1-1";
+const char* beaconOverlay   = "/";
+const char* beaconHeader    = "CA2RXU-7>APLRT1,WIDE1-1:!/";     // BEACON_Utils template
+const char* beaconComment   = "LoRa APRS Tracker";
+String      beaconPosition  = "6A4:Nq9a>Q2Bk";
+String      batteryVoltage  = "3.91";
+String      batteryPercent  = "80";
+
+namespace Legacy {      // sendBeacon() before BEACON_Utils
+
+    String generateBase91GPSBeaconPacket(const String& callsign, const String& tocall, const String& path, const String& overlay, const String& gpsData) {
+        String packet = callsign;       // as APRSPacketLib assembles it
+        packet += ">";
+        packet += tocall;
+        if (path != "") packet += "," + path;
+        packet += ":!";
+        packet += overlay;
+        packet += gpsData;
+        return packet;
+    }
+
+    String buildBeacon() {
+        String packet = generateBase91GPSBeaconPacket(beaconCallsign, "APLRT1", beaconPath, beaconOverlay, beaconPosition);
+        String comment = beaconComment;
+        comment += " Bat=";
+        comment += String(batteryVoltage.toFloat(),2);
+        comment += "V";
+        comment += batteryPercent;
+        comment += "%";
+        packet += comment;
+        return packet;
+    }
+
+}
+
+void appendf(BeaconPacket& packet, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    BEACON_Utils::vappendf(packet, format, args);
+    va_end(args);
+}
+
+String buildBeacon() {
+    static BeaconPacket packet;
+    BEACON_Utils::clear(packet);
+    BEACON_Utils::append(packet, beaconHeader, strlen(beaconHeader));
+    BEACON_Utils::append(packet, beaconPosition.c_str(), beaconPosition.length());
+    BEACON_Utils::append(packet, beaconComment, strlen(beaconComment));
+    appendf(packet, " Bat=%.2fV%s%%", batteryVoltage.toFloat(), batteryPercent.c_str());
+    return String(packet.data);
+}
+
+// Payloads of messages addressed to us, one per keyword and plain text.
+const char* messagePayloads[] = {
+    "ack123",
+    "ping",
+    "PING please",
+    "WX Santiago,Clear, 12.3P1013H80W2.5,x,270",
+    "Login [482]:",
+    "Log off successful",
+    "Login valid for 2 hours",
+    "hello from the hills{42"
+};
+const int   messagePayloadsSize = sizeof(messagePayloads) / sizeof(messagePayloads[0]);
+String      messageCorpus[messagePayloadsSize];
+
+namespace Legacy {      // checkReceivedMessage() before the keyword trie
+
+    PayloadKeyword classifyPayload(const String& payload) {
+        if (payload.indexOf("ack") == 0) return KEYWORD_ACK;
+        if (payload.indexOf("ping") == 0 || payload.indexOf("Ping") == 0 || payload.indexOf("PING") == 0) return KEYWORD_PING;
+        if (payload.indexOf("WX") == 0) return KEYWORD_WX;
+        if (payload.indexOf("Login [") == 0) return KEYWORD_LOGIN_CHALLENGE;
+        if (payload.indexOf("Log off successful") == 0) return KEYWORD_LOG_OFF;
+        return KEYWORD_NONE;
+    }
+
+    int parseWeatherReport(const String& payload) {
+        const String& wxCleaning     = payload.substring(payload.indexOf("WX ") + 3);
+        const String& place          = wxCleaning.substring(0,wxCleaning.indexOf(","));
+        const String& placeCleaning  = wxCleaning.substring(wxCleaning.indexOf(",")+1);
+        const String& summary        = placeCleaning.substring(0,placeCleaning.indexOf(","));
+        const String& sumCleaning    = placeCleaning.substring(placeCleaning.indexOf(",")+2);
+        const String& temperature    = sumCleaning.substring(0,sumCleaning.indexOf("P"));
+        const String& tempCleaning   = sumCleaning.substring(sumCleaning.indexOf("P")+1);
+        const String& pressure       = tempCleaning.substring(0,tempCleaning.indexOf("H"));
+        const String& presCleaning   = tempCleaning.substring(tempCleaning.indexOf("H")+1);
+        const String& humidity       = presCleaning.substring(0,presCleaning.indexOf("W"));
+        const String& humCleaning    = presCleaning.substring(presCleaning.indexOf("W")+1);
+        const String& windSpeed      = humCleaning.substring(0,humCleaning.indexOf(","));
+        const String& windCleaning   = humCleaning.substring(humCleaning.indexOf(",")+1);
+        const String& windDegrees    = windCleaning.substring(windCleaning.indexOf(",")+1,windCleaning.indexOf("\n"));
+        return place.length() + summary.length() + temperature.length() + pressure.length() + humidity.length() + windSpeed.length() + windDegrees.length();
+    }
+
+}
+
+int parseWeatherReport(const String& payload) {     // as handleWeatherReply()
+    char place[32], summary[32], temperature[8], pressure[8], humidity[8], windSpeed[8], windDegrees[8];
+    PayloadTokenizer tokens(payload);
+    tokens.skip(2);
+    if (tokens.cursor < tokens.end && *tokens.cursor == ' ') tokens.skip(1);
+    tokens.next(',', place, sizeof(place));
+    tokens.next(',', summary, sizeof(summary));
+    tokens.skip(1);
+    tokens.next('P', temperature, sizeof(temperature));
+    tokens.next('H', pressure, sizeof(pressure));
+    tokens.next('W', humidity, sizeof(humidity));
+    tokens.next(',', windSpeed, sizeof(windSpeed));
+    tokens.skipPast(',');
+    tokens.next('\n', windDegrees, sizeof(windDegrees));
+    return strlen(place) + strlen(summary) + strlen(temperature) + strlen(pressure) + strlen(humidity) + strlen(windSpeed) + strlen(windDegrees);
+}
+
+struct DistancePair {
+    PositionContext from;
+    float           latitude;
+    float           longitude;
+    double          distanceKm;     // double-precision haversine, as TinyGPS++
+    double          course;
+};
+DistancePair    distancePairs[DISTANCE_PAIRS];
+
+// Stations up to FAST_DISTANCE_LIMIT away in every direction, latitudes within +/-80 deg.
+void buildDistancePairs() {
+    const double degToRad = M_PI / 180.0;
+    srand(12);
+    for (int i = 0; i < DISTANCE_PAIRS; i++) {
+        double latitude     = (rand() / (double)RAND_MAX * 160.0 - 80.0) * degToRad;
+        double longitude    = (rand() / (double)RAND_MAX * 360.0 - 180.0) * degToRad;
+        double angle        = (i + 1) * (double)FAST_DISTANCE_LIMIT / DISTANCE_PAIRS / EARTH_RADIUS_KM;
+        double course       = rand() / (double)RAND_MAX * 2.0 * M_PI;
+        double toLatitude   = asin(sin(latitude) * cos(angle) + cos(latitude) * sin(angle) * cos(course));
+        double toLongitude  = longitude + atan2(sin(course) * sin(angle) * cos(latitude), cos(angle) - sin(latitude) * sin(toLatitude));
+
+        DistancePair& pair = distancePairs[i];
+        GPS_Utils::setPositionContext(pair.from, latitude / degToRad, longitude / degToRad);
+        pair.latitude   = toLatitude / degToRad;
+        pair.longitude  = remainder(toLongitude / degToRad, 360.0);
+
+        double fromLatitude = pair.from.latitude * degToRad, fromLongitude = pair.from.longitude * degToRad;     // as the float inputs
+        double lat = pair.latitude * degToRad, deltaLongitude = pair.longitude * degToRad - fromLongitude;
+        double h = pow(sin((lat - fromLatitude) / 2), 2) + cos(fromLatitude) * cos(lat) * pow(sin(deltaLongitude / 2), 2);
+        pair.distanceKm = 2.0 * EARTH_RADIUS_KM * asin(sqrt(h));
+        pair.course     = fmod(atan2(sin(deltaLongitude) * cos(lat), cos(fromLatitude) * sin(lat) - sin(fromLatitude) * cos(lat) * cos(deltaLongitude)) / degToRad + 360.0, 360.0);
+    }
+}
+
+
+void setUp() {
+    kissFrameLength = KISS_Utils::encodeKISS(tnc2Frame, strlen(tnc2Frame), kissFrame, sizeof(kissFrame));
+    for (int i = 0; i < corpusSize; i++) legacyKissCorpus[i] = Legacy::encodeKISS(corpus[i]);
+    buildDistancePairs();
+    MSGBUFFER_Utils::setup(0);
+    for (int i = 0; i < messagePayloadsSize; i++) messageCorpus[i] = messagePayloads[i];
+}
+
+void tearDown() {}
+
+void test_benchmark_encode_kiss() {
+    BenchmarkResult result = benchmark("KISS_Utils::encodeKISS", [] {
+        uint8_t output[KISS_MAX_ENCODED_FRAME];
+        benchmarkSink = KISS_Utils::encodeKISS(tnc2Frame, sizeof(tnc2Frame) - 1, output, sizeof(output));
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, result.allocations);
+}
+
+void test_benchmark_decode_kiss() {
+    BenchmarkResult result = benchmark("KissDeframer + decodeAX25", [] {
+        KissDeframer deframer;
+        char output[KISS_MAX_FRAME];
+        for (int i = 0; i < kissFrameLength; i++) {
+            if (deframer.feed(kissFrame[i])) benchmarkSink = KISS_Utils::decodeAX25(deframer.data(), deframer.length(), output, sizeof(output));
+        }
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, result.allocations);
+}
+
+void test_corpus_matches_legacy() {
+    for (int i = 0; i < corpusSize; i++) {
+        uint8_t encoded[KISS_MAX_ENCODED_FRAME];
+        int length = KISS_Utils::encodeKISS(corpus[i], strlen(corpus[i]), encoded, sizeof(encoded));
+        TEST_ASSERT_EQUAL_INT(legacyKissCorpus[i].length(), length);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(legacyKissCorpus[i].c_str(), encoded, length);
+
+        char decoded[KISS_MAX_FRAME];
+        TEST_ASSERT_EQUAL_INT(strlen(corpus[i]), KISS_Utils::decodeAX25(encoded + 2, length - 3, decoded, sizeof(decoded)));
+        TEST_ASSERT_EQUAL_STRING(corpus[i], decoded);
+    }
+}
+
+void test_benchmark_corpus_round_trip() {
+    BenchmarkResult legacy = benchmark("corpus round trip, String", [] {
+        for (int i = 0; i < corpusSize; i++) {
+            bool dataFrame;
+            benchmarkSink = Legacy::decodeKISS(Legacy::encodeKISS(corpus[i]), dataFrame).length();
+        }
+    });
+    BenchmarkResult buffer = benchmark("corpus round trip, buffers", [] {
+        for (int i = 0; i < corpusSize; i++) {
+            uint8_t encoded[KISS_MAX_ENCODED_FRAME];
+            char decoded[KISS_MAX_FRAME];
+            int length = KISS_Utils::encodeKISS(corpus[i], strlen(corpus[i]), encoded, sizeof(encoded));
+            benchmarkSink = KISS_Utils::decodeAX25(encoded + 2, length - 3, decoded, sizeof(decoded));
+        }
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, buffer.allocations);
+    TEST_ASSERT_TRUE(buffer.nsPerOp < legacy.nsPerOp);
+}
+
+void test_benchmark_maidenhead_locator() {
+    BenchmarkResult result = benchmark("Utils::getMaidenheadLocator", [] {
+        benchmarkSink = Utils::getMaidenheadLocator(-33.45, -70.47, 8)[7];
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, result.allocations);
+}
+
+void test_benchmark_cardinal_direction() {
+    float bearing = 0.0;
+    benchmark("GPS_Utils::getCardinalDirection", [&bearing] {
+        bearing = bearing >= 359.0 ? 0.0 : bearing + 1.0;
+        benchmarkSink = GPS_Utils::getCardinalDirection(bearing).length();
+    });
+}
+
+void test_benchmark_encoded_telemetry_bytes() {
+    benchmark("generateEncodedTelemetryBytes", [] {
+        benchmarkSink = TELEMETRY_Utils::generateEncodedTelemetryBytes(21.5, false, 2).length();
+    });
+}
+
+void test_beacon_matches_legacy() {
+    String legacy = Legacy::buildBeacon();
+    String packet = buildBeacon();
+    TEST_ASSERT_EQUAL_STRING(legacy.c_str(), packet.c_str());
+}
+
+void test_benchmark_beacon() {
+    BenchmarkResult legacy = benchmark("beacon, String concatenation", [] {
+        benchmarkSink = Legacy::buildBeacon().length();
+    });
+    BenchmarkResult buffer = benchmark("beacon, template + buffer", [] {
+        benchmarkSink = buildBeacon().length();
+    });
+    TEST_ASSERT_EQUAL_UINT32(BENCHMARK_ITERATIONS, buffer.allocations);      // the finished String only
+    TEST_ASSERT_TRUE(buffer.allocations < legacy.allocations);
+}
+
+void test_dispatch_matches_legacy() {
+    for (int i = 0; i < messagePayloadsSize; i++) {
+        TEST_ASSERT_EQUAL_INT(Legacy::classifyPayload(messageCorpus[i]), MSGBUFFER_Utils::classifyPayload(messagePayloads[i]));
+    }
+    TEST_ASSERT_EQUAL_INT(Legacy::parseWeatherReport(messageCorpus[3]), parseWeatherReport(messageCorpus[3]));
+}
+
+void test_benchmark_classify_payload() {
+    BenchmarkResult legacy = benchmark("classify payloads, indexOf", [] {
+        for (int i = 0; i < messagePayloadsSize; i++) benchmarkSink = Legacy::classifyPayload(messageCorpus[i]);
+    });
+    BenchmarkResult trie = benchmark("classify payloads, trie", [] {
+        for (int i = 0; i < messagePayloadsSize; i++) benchmarkSink = MSGBUFFER_Utils::classifyPayload(messageCorpus[i].c_str());
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, trie.allocations);
+    TEST_ASSERT_TRUE(trie.nsPerOp < legacy.nsPerOp);
+}
+
+void test_benchmark_weather_report() {
+    BenchmarkResult legacy = benchmark("WX report, substring chain", [] {
+        benchmarkSink = Legacy::parseWeatherReport(messageCorpus[3]);
+    });
+    BenchmarkResult tokenizer = benchmark("WX report, PayloadTokenizer", [] {
+        benchmarkSink = parseWeatherReport(messageCorpus[3]);
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, tokenizer.allocations);
+    TEST_ASSERT_TRUE(tokenizer.allocations < legacy.allocations);
+}
+
+void test_fast_distance_error() {
+    double maxDistanceError = 0.0, maxCourseError = 0.0;
+    for (const DistancePair& pair : distancePairs) {
+        float distanceKm, course;
+        GPS_Utils::getDistanceCourse(pair.from, pair.latitude, pair.longitude, distanceKm, course);
+        maxDistanceError = fmax(maxDistanceError, fabs(distanceKm - pair.distanceKm));
+        if (pair.distanceKm < FAST_DISTANCE_LIMIT / 10) continue;  // course of nearby stations is float rounding
+        double courseError = fabs(course - pair.course);
+        maxCourseError = fmax(maxCourseError, fmin(courseError, 360.0 - courseError));
+    }
+    printf("distance up to %.0f km: max error %.1f m, course %.2f deg\n", FAST_DISTANCE_LIMIT, maxDistanceError * 1000.0, maxCourseError);
+    TEST_ASSERT_TRUE(maxDistanceError < 0.005);
+    TEST_ASSERT_TRUE(maxCourseError < 0.1);
+}
+
+void test_benchmark_distance_course() {
+    int i = 0;
+    BenchmarkResult haversine = benchmark("distance+course, haversine", [&i] {
+        const DistancePair& pair = distancePairs[i++ % DISTANCE_PAIRS];
+        float distanceKm, course;
+        GPS_Utils::getGreatCircleDistanceCourse(pair.from, pair.latitude, pair.longitude, distanceKm, course);
+        benchmarkSink = (int)(distanceKm + course);
+    });
+    BenchmarkResult fast = benchmark("distance+course, equirectangular", [&i] {
+        const DistancePair& pair = distancePairs[i++ % DISTANCE_PAIRS];
+        float distanceKm, course;
+        GPS_Utils::getFastDistanceCourse(pair.from, pair.latitude, pair.longitude, distanceKm, course);
+        benchmarkSink = (int)(distanceKm + course);
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, fast.allocations);
+    TEST_ASSERT_TRUE(fast.nsPerOp < haversine.nsPerOp);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_encode_kiss);
+    RUN_TEST(test_benchmark_decode_kiss);
+    RUN_TEST(test_corpus_matches_legacy);
+    RUN_TEST(test_benchmark_corpus_round_trip);
+    RUN_TEST(test_benchmark_maidenhead_locator);
+    RUN_TEST(test_benchmark_cardinal_direction);
+    RUN_TEST(test_benchmark_encoded_telemetry_bytes);
+    RUN_TEST(test_beacon_matches_legacy);
+    RUN_TEST(test_benchmark_beacon);
+    RUN_TEST(test_dispatch_matches_legacy);
+    RUN_TEST(test_benchmark_classify_payload);
+    RUN_TEST(test_benchmark_weather_report);
+    RUN_TEST(test_fast_distance_error);
+    RUN_TEST(test_benchmark_distance_course);
+    return UNITY_END();
+}
@@ -0,0 +1,230 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <unity.h>
+#include "telemetry_utils.h"
+#include "beacon_utils.h"
+#include "kiss_utils.h"
+#include "gps_utils.h"
+#include "utils.h"
+
+
+void setUp() {}
+void tearDown() {}
+
+const char      tnc2Frame[]     = "CA2RXU-7>APLRT1,WIDE1-1:!hello";
+const uint8_t   kissFrame[]     = {
+    0xc0, 0x00,
+    0x82, 0xa0, 0x98, 0xa4, 0xa8, 0x62, 0x60,      // APLRT1
+    0x86, 0x82, 0x64, 0xa4, 0xb0, 0xaa, 0x6e,      // CA2RXU-7
+    0xae, 0x92, 0x88, 0x8a, 0x62, 0x40, 0x63,      // WIDE1-1, last address
+    0x03, 0xf0,
+    '!', 'h', 'e', 'l', 'l', 'o',
+    0xc0
+};
+
+int encode(const char* frame, uint8_t* output, size_t size = KISS_MAX_ENCODED_FRAME) {
+    return KISS_Utils::encodeKISS(frame, strlen(frame), output, size);
+}
+
+String roundTrip(const char* frame) {  // TNC2 -> KISS -> deframer -> TNC2
+    uint8_t encoded[KISS_MAX_ENCODED_FRAME];
+    int length = encode(frame, encoded);
+    TEST_ASSERT_GREATER_THAN(0, length);
+
+    KissDeframer deframer;
+    bool ready = false;
+    for (int i = 0; i < length; i++) ready = deframer.feed(encoded[i]);
+    TEST_ASSERT_TRUE(ready);
+    TEST_ASSERT_EQUAL_UINT8(KissCmd::Data, deframer.command());
+
+    char decoded[KISS_MAX_FRAME];
+    TEST_ASSERT_GREATER_THAN(0, KISS_Utils::decodeAX25(deframer.data(), deframer.length(), decoded, sizeof(decoded)));
+    return String(decoded);
+}
+
+void test_encode_kiss() {
+    uint8_t encoded[KISS_MAX_ENCODED_FRAME];
+    TEST_ASSERT_EQUAL_INT(sizeof(kissFrame), encode(tnc2Frame, encoded));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(kissFrame, encoded, sizeof(kissFrame));
+}
+
+void test_encode_kiss_escapes_payload() {
+    const char frame[] = "CA2RXU>APLRT1:\xc0\xdb";
+    uint8_t encoded[KISS_MAX_ENCODED_FRAME];
+    int length = encode(frame, encoded);
+    TEST_ASSERT_EQUAL_INT(2 + 14 + 2 + 4 + 1, length);
+    const uint8_t tail[] = {0xdb, 0xdc, 0xdb, 0xdd, 0xc0};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(tail, encoded + length - 5, 5);
+}
+
+void test_encode_kiss_errors() {
+    uint8_t encoded[KISS_MAX_ENCODED_FRAME];
+    TEST_ASSERT_EQUAL_INT(KissErrorFrame, encode("CA2RXU>APLRT1 no info field", encoded));
+    TEST_ASSERT_EQUAL_INT(KissErrorFrame, encode("no header:text", encoded));
+    TEST_ASSERT_EQUAL_INT(KissErrorAddress, encode("CA2RXUX>APLRT1:x", encoded));
+    TEST_ASSERT_EQUAL_INT(KissErrorAddress, encode("CA2RXU-16>APLRT1:x", encoded));
+    TEST_ASSERT_EQUAL_INT(KissErrorAddress, encode("CA2RXU-A>APLRT1:x", encoded));
+    TEST_ASSERT_EQUAL_INT(KissErrorDigis, encode("CA2RXU>APLRT1,A,B,C,D,E,F,G,H,I:x", encoded));
+    TEST_ASSERT_EQUAL_INT(KissErrorBuffer, encode(tnc2Frame, encoded, 10));
+}
+
+void test_decode_ax25() {
+    char decoded[KISS_MAX_FRAME];
+    int length = KISS_Utils::decodeAX25(kissFrame + 2, sizeof(kissFrame) - 3, decoded, sizeof(decoded));
+    TEST_ASSERT_EQUAL_INT(strlen(tnc2Frame), length);
+    TEST_ASSERT_EQUAL_STRING(tnc2Frame, decoded);
+}
+
+void test_decode_ax25_errors() {
+    char decoded[KISS_MAX_FRAME];
+    TEST_ASSERT_EQUAL_INT(KissErrorFrame, KISS_Utils::decodeAX25(kissFrame + 2, 15, decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_INT(KissErrorBuffer, KISS_Utils::decodeAX25(kissFrame + 2, sizeof(kissFrame) - 3, decoded, 10));
+    TEST_ASSERT_EQUAL_STRING("CA2RXU-7>", decoded);     // truncated but terminated
+}
+
+void test_round_trip() {
+    const char* frames[] = {
+        tnc2Frame,
+        "CA2RXU-12>APLRT1,WIDE1-1*,WIDE2-1::CD2RXU   :hi{1",     // SSID >= 10, digipeated flag
+        "N0CALL>APZ:\xc0\xdb"
+    };
+    for (const char* frame : frames) {
+        String decoded = roundTrip(frame);
+        TEST_ASSERT_EQUAL_STRING(frame, decoded.c_str());
+    }
+}
+
+void test_deframer() {
+    KissDeframer deframer;
+    const uint8_t stream[] = {'x', 'y', 0xc0, 0x00, 'a', 0xdb, 0xdc, 'b', 0xc0, 0xc0, 0x00, 'c', 0xdb, 'z', 'd', 0xc0, 0x00, 'e', 0xc0};
+    int frames = 0;
+    for (size_t i = 0; i < sizeof(stream); i++) {
+        if (!deframer.feed(stream[i])) continue;
+        frames++;
+        if (frames == 1) {
+            const uint8_t first[] = {'a', 0xc0, 'b'};
+            TEST_ASSERT_EQUAL_size_t(3, deframer.length());
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(first, deframer.data(), 3);
+        } else {
+            TEST_ASSERT_EQUAL_size_t(1, deframer.length());     // bad escape frame dropped
+            TEST_ASSERT_EQUAL_UINT8('e', deframer.data()[0]);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(2, frames);
+}
+
+void test_validate_tnc2_frame() {
+    TEST_ASSERT_TRUE(KISS_Utils::validateTNC2Frame(String(tnc2Frame)));
+    TEST_ASSERT_FALSE(KISS_Utils::validateTNC2Frame(String("CA2RXU:APLRT1>x")));
+    TEST_ASSERT_FALSE(KISS_Utils::validateTNC2Frame(String("CA2RXU>APLRT1")));
+}
+
+void test_maidenhead_locator() {
+    TEST_ASSERT_EQUAL_STRING("JJ00AA", Utils::getMaidenheadLocator(0.0, 0.0, 6));
+    TEST_ASSERT_EQUAL_STRING("JN58TD", Utils::getMaidenheadLocator(48.14666, 11.60833, 6));
+    TEST_ASSERT_EQUAL_STRING("JN58TD35", Utils::getMaidenheadLocator(48.14666, 11.60833, 8));
+    TEST_ASSERT_EQUAL_STRING("FF46SN", Utils::getMaidenheadLocator(-33.45, -70.47, 6));
+    TEST_ASSERT_EQUAL_STRING("FF46SN", Utils::getMaidenheadLocator(-33.45, -70.47, 7));    // odd sizes round down
+    TEST_ASSERT_EQUAL_STRING("FF46SN", Utils::getMaidenheadLocator(-33.45, -70.47, 0));    // out of range: 6
+    TEST_ASSERT_EQUAL_INT(10, strlen(Utils::getMaidenheadLocator(-33.45, -70.47, 10)));
+}
+
+void test_cardinal_direction() {
+    struct {
+        float       bearing;
+        const char* scale;
+    } cases[] = {
+        {0.0,   ">.NW.....(N).....NE.<"},
+        {359.9, ">.NW.....(N).....NE.<"},
+        {5.65,  ">.......N.|.....NE..<"},
+        {45.0,  ">.N......(NE).....E.<"},
+        {90.0,  ">.NE.....(E).....SE.<"},
+        {180.0, ">.SE.....(S).....SW.<"},
+        {270.0, ">.SW.....(W).....NW.<"}
+    };
+    for (const auto& testCase : cases) {
+        String scale = GPS_Utils::getCardinalDirection(testCase.bearing);
+        TEST_ASSERT_EQUAL_STRING(testCase.scale, scale.c_str());
+    }
+    for (float bearing = 0.0; bearing < 360.0; bearing += 0.05) {      // no gaps between the sectors
+        TEST_ASSERT_EQUAL_INT(21, GPS_Utils::getCardinalDirection(bearing).length());
+    }
+}
+
+void test_encoded_telemetry_bytes() {
+    struct {
+        float       value;
+        bool        counterBytes;
+        byte        telemetryType;
+        const char* encoded;
+    } cases[] = {
+        {123,       true,   0,  "\"A"},    // counter
+        {0,         true,   0,  "!!"},
+        {3.5,       false,  0,  "$n"},      // internal voltage
+        {12.0,      false,  1,  "'W"},      // external voltage
+        {21.5,      false,  2,  "(o"},      // temperature
+        {1013.25,   false,  3,  "z("}       // pressure
+    };
+    for (const auto& testCase : cases) {
+        String encoded = TELEMETRY_Utils::generateEncodedTelemetryBytes(testCase.value, testCase.counterBytes, testCase.telemetryType);
+        TEST_ASSERT_EQUAL_STRING(testCase.encoded, encoded.c_str());
+    }
+}
+
+void appendBattery(BeaconPacket& packet, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    BEACON_Utils::vappendf(packet, format, args);
+    va_end(args);
+}
+
+void test_beacon_packet() {
+    BeaconPacket packet;
+    BEACON_Utils::clear(packet);
+    BEACON_Utils::append(packet, "CA2RXU-7>APLRT1:!/", 18);
+    BEACON_Utils::append(packet, "6A4:Nq9a>Q2Bk", 13);
+    appendBattery(packet, " Bat=%.2fV%s%%", 3.9, "80");
+    TEST_ASSERT_EQUAL_STRING("CA2RXU-7>APLRT1:!/6A4:Nq9a>Q2Bk Bat=3.90V80%", packet.data);
+    TEST_ASSERT_EQUAL_size_t(strlen(packet.data), packet.length);
+
+    char comment[BEACON_MAX_LENGTH];
+    memset(comment, 'x', sizeof(comment));
+    BEACON_Utils::append(packet, comment, sizeof(comment));     // truncated, still terminated
+    TEST_ASSERT_EQUAL_size_t(BEACON_MAX_LENGTH - 1, packet.length);
+    TEST_ASSERT_EQUAL_size_t(BEACON_MAX_LENGTH - 1, strlen(packet.data));
+    appendBattery(packet, " Bat=%.2fV", 3.9);
+    TEST_ASSERT_EQUAL_size_t(BEACON_MAX_LENGTH - 1, packet.length);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_encode_kiss);
+    RUN_TEST(test_encode_kiss_escapes_payload);
+    RUN_TEST(test_encode_kiss_errors);
+    RUN_TEST(test_decode_ax25);
+    RUN_TEST(test_decode_ax25_errors);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_deframer);
+    RUN_TEST(test_validate_tnc2_frame);
+    RUN_TEST(test_maidenhead_locator);
+    RUN_TEST(test_cardinal_direction);
+    RUN_TEST(test_encoded_telemetry_bytes);
+    RUN_TEST(test_beacon_packet);
+    return UNITY_END();
+}
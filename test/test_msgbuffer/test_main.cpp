@@ -0,0 +1,211 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <unity.h>
+#include "msgbuffer_utils.h"
+
+#define START_TIME      5000
+#define DEDUP_WINDOW    60000
+
+
+extern OutgoingMessage  messagePool[MSG_POOL_SIZE];
+
+int8_t      retried[MSG_POOL_SIZE];
+uint8_t     retriedCount;
+
+void collectRetry(int8_t index, uint32_t now) {
+    retried[retriedCount++] = index;
+}
+
+void setUp() {
+    MSGBUFFER_Utils::setup(START_TIME);
+    retriedCount = 0;
+}
+
+void tearDown() {}
+
+void test_hash_packet() {
+    uint32_t hash = MSGBUFFER_Utils::hashPacket("CA2RXU-7", "hello");
+    TEST_ASSERT_EQUAL_UINT32(hash, MSGBUFFER_Utils::hashPacket("CA2RXU-7", "hello"));
+    TEST_ASSERT_TRUE(hash != MSGBUFFER_Utils::hashPacket("CA2RXU-7", "hellO"));
+    TEST_ASSERT_TRUE(MSGBUFFER_Utils::hashPacket("CA2RXU", "-7hello") != MSGBUFFER_Utils::hashPacket("CA2RXU-7", "hello"));
+    TEST_ASSERT_TRUE(MSGBUFFER_Utils::hashPacket("", "") != 0);
+}
+
+void test_duplicate_within_window() {
+    TEST_ASSERT_TRUE(MSGBUFFER_Utils::checkDuplicate("CA2RXU-7", "hello", START_TIME, DEDUP_WINDOW));
+    TEST_ASSERT_FALSE(MSGBUFFER_Utils::checkDuplicate("CA2RXU-7", "hello", START_TIME + 1000, DEDUP_WINDOW));
+    TEST_ASSERT_TRUE(MSGBUFFER_Utils::checkDuplicate("CD2RXU", "hello", START_TIME + 1000, DEDUP_WINDOW));
+    TEST_ASSERT_TRUE(MSGBUFFER_Utils::checkDuplicate("CA2RXU-7", "hello", START_TIME + DEDUP_WINDOW, DEDUP_WINDOW));
+}
+
+void test_duplicate_oldest_overwritten() {
+    char text[8];
+    for (int i = 0; i <= DUPLICATE_BUFFER_SIZE; i++) {
+        snprintf(text, sizeof(text), "%d", i);
+        TEST_ASSERT_TRUE(MSGBUFFER_Utils::checkDuplicate("CA2RXU-7", text, START_TIME, DEDUP_WINDOW));
+    }
+    TEST_ASSERT_TRUE(MSGBUFFER_Utils::checkDuplicate("CA2RXU-7", "0", START_TIME, DEDUP_WINDOW));
+    TEST_ASSERT_FALSE(MSGBUFFER_Utils::checkDuplicate("CA2RXU-7", "2", START_TIME, DEDUP_WINDOW));
+}
+
+void test_classify_payload() {
+    TEST_ASSERT_EQUAL_INT(KEYWORD_ACK, MSGBUFFER_Utils::classifyPayload("ack12"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_PING, MSGBUFFER_Utils::classifyPayload("ping"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_PING, MSGBUFFER_Utils::classifyPayload("Ping?"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_PING, MSGBUFFER_Utils::classifyPayload("PING"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_WX, MSGBUFFER_Utils::classifyPayload("WX Santiago,Clear"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_LOGIN_CHALLENGE, MSGBUFFER_Utils::classifyPayload("Login [123456]:"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_LOG_OFF, MSGBUFFER_Utils::classifyPayload("Log off successful"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_NONE, MSGBUFFER_Utils::classifyPayload("Log off"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_NONE, MSGBUFFER_Utils::classifyPayload("ac"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_NONE, MSGBUFFER_Utils::classifyPayload("hello ack"));
+    TEST_ASSERT_EQUAL_INT(KEYWORD_NONE, MSGBUFFER_Utils::classifyPayload(""));
+}
+
+void test_payload_tokenizer() {
+    String payload = "WX Santiago,Clear, 12.3P1013H80W2.5,x,270";
+    char place[16], summary[16], temperature[8], pressure[8], humidity[8], windSpeed[8], windDegrees[8];
+    PayloadTokenizer tokens(payload);
+    tokens.skip(3);
+    tokens.next(',', place, sizeof(place));
+    tokens.next(',', summary, sizeof(summary));
+    tokens.skip(1);
+    tokens.next('P', temperature, sizeof(temperature));
+    tokens.next('H', pressure, sizeof(pressure));
+    tokens.next('W', humidity, sizeof(humidity));
+    tokens.next(',', windSpeed, sizeof(windSpeed));
+    tokens.skipPast(',');
+    tokens.next('\n', windDegrees, sizeof(windDegrees));
+    TEST_ASSERT_EQUAL_STRING("Santiago", place);
+    TEST_ASSERT_EQUAL_STRING("Clear", summary);
+    TEST_ASSERT_EQUAL_STRING("12.3", temperature);
+    TEST_ASSERT_EQUAL_STRING("1013", pressure);
+    TEST_ASSERT_EQUAL_STRING("80", humidity);
+    TEST_ASSERT_EQUAL_STRING("2.5", windSpeed);
+    TEST_ASSERT_EQUAL_STRING("270", windDegrees);
+
+    char token[4];
+    tokens.next(',', token, sizeof(token));     // past the end
+    TEST_ASSERT_EQUAL_STRING("", token);
+    PayloadTokenizer longToken(payload);
+    longToken.next(',', token, sizeof(token));  // truncated to the buffer
+    TEST_ASSERT_EQUAL_STRING("WX ", token);
+    TEST_ASSERT_EQUAL_STRING("Clear, 12.3P1013H80W2.5,x,270", longToken.cursor);
+}
+
+void test_pool_queue_order() {
+    int8_t first    = MSGBUFFER_Utils::addMessage("CA2RXU-7", "first");
+    int8_t second   = MSGBUFFER_Utils::addMessage("CD2RXU", "second");
+    TEST_ASSERT_TRUE(first >= 0 && second >= 0 && first != second);
+    TEST_ASSERT_EQUAL_INT(MSG_ALREADY_QUEUED, MSGBUFFER_Utils::addMessage("CA2RXU-7", "first"));
+    TEST_ASSERT_EQUAL_INT(first, MSGBUFFER_Utils::nextPending());
+
+    messagePool[first].state = MSG_STATE_FREE;
+    TEST_ASSERT_EQUAL_INT(second, MSGBUFFER_Utils::nextPending());
+    int8_t third = MSGBUFFER_Utils::addMessage("CA2RXU-7", "first");   // reuses the freed slot, queued last
+    TEST_ASSERT_EQUAL_INT(first, third);
+    TEST_ASSERT_EQUAL_INT(second, MSGBUFFER_Utils::nextPending());
+}
+
+void test_pool_full_and_truncated() {
+    char text[8];
+    for (int i = 0; i < MSG_POOL_SIZE; i++) {
+        snprintf(text, sizeof(text), "%d", i);
+        TEST_ASSERT_TRUE(MSGBUFFER_Utils::addMessage("CA2RXU-7", text) >= 0);
+    }
+    TEST_ASSERT_EQUAL_INT(MSG_POOL_FULL, MSGBUFFER_Utils::addMessage("CA2RXU-7", "one more"));
+
+    MSGBUFFER_Utils::setup(START_TIME);
+    String longText;
+    for (int i = 0; i < MSG_TEXT_SIZE + 10; i++) longText += 'x';
+    int8_t index = MSGBUFFER_Utils::addMessage("CA2RXU-7", longText.c_str());
+    TEST_ASSERT_EQUAL_size_t(MSG_TEXT_SIZE, strlen(messagePool[index].text));
+}
+
+void test_ack_releases_message() {
+    int8_t index = MSGBUFFER_Utils::addMessage("CA2RXU-7", "hello");
+    messagePool[index].msgNumber = 42;
+    MSGBUFFER_Utils::waitForAck(index, START_TIME + 30000);
+    TEST_ASSERT_EQUAL_INT(MSG_STATE_WAITING_ACK, messagePool[index].state);
+
+    TEST_ASSERT_FALSE(MSGBUFFER_Utils::processAck("CA2RXU-7", 43));
+    TEST_ASSERT_FALSE(MSGBUFFER_Utils::processAck("CD2RXU", 42));
+    TEST_ASSERT_TRUE(MSGBUFFER_Utils::processAck("CA2RXU-7", 42));
+    TEST_ASSERT_EQUAL_INT(MSG_STATE_FREE, messagePool[index].state);
+    TEST_ASSERT_FALSE(MSGBUFFER_Utils::processAck("CA2RXU-7", 42));
+
+    MSGBUFFER_Utils::processWheel(START_TIME + 60000, collectRetry);    // no longer on the wheel
+    TEST_ASSERT_EQUAL_UINT8(0, retriedCount);
+}
+
+void test_wheel_hands_out_due_retries() {
+    int8_t soon = MSGBUFFER_Utils::addMessage("CA2RXU-7", "soon");
+    int8_t late = MSGBUFFER_Utils::addMessage("CD2RXU", "late");
+    messagePool[soon].msgNumber = 1;
+    messagePool[late].msgNumber = 2;
+    MSGBUFFER_Utils::waitForAck(soon, START_TIME + 30000);
+    MSGBUFFER_Utils::waitForAck(late, START_TIME + 120000);
+
+    MSGBUFFER_Utils::processWheel(START_TIME + 29000, collectRetry);
+    TEST_ASSERT_EQUAL_UINT8(0, retriedCount);
+    MSGBUFFER_Utils::processWheel(START_TIME + 30000, collectRetry);
+    TEST_ASSERT_EQUAL_UINT8(1, retriedCount);
+    TEST_ASSERT_EQUAL_INT(soon, retried[0]);
+
+    // more than one turn of the wheel ahead: put back, handed out only once due
+    MSGBUFFER_Utils::expireMessage(soon);
+    MSGBUFFER_Utils::processWheel(START_TIME + 119000, collectRetry);
+    TEST_ASSERT_EQUAL_UINT8(1, retriedCount);
+    MSGBUFFER_Utils::processWheel(START_TIME + 121000, collectRetry);
+    TEST_ASSERT_EQUAL_UINT8(2, retriedCount);
+    TEST_ASSERT_EQUAL_INT(late, retried[1]);
+    TEST_ASSERT_EQUAL_INT(MSG_STATE_FREE, messagePool[soon].state);
+    TEST_ASSERT_FALSE(MSGBUFFER_Utils::processAck("CA2RXU-7", 1));
+}
+
+void test_release_messages_of_station() {
+    int8_t winlink = MSGBUFFER_Utils::addMessage("WLNK-1", "L");
+    int8_t other   = MSGBUFFER_Utils::addMessage("CA2RXU-7", "hello");
+    messagePool[winlink].msgNumber  = 7;
+    messagePool[other].msgNumber    = 8;
+    MSGBUFFER_Utils::waitForAck(winlink, START_TIME + 30000);
+    MSGBUFFER_Utils::waitForAck(other, START_TIME + 30000);
+
+    MSGBUFFER_Utils::releaseMessages("WLNK-1");
+    TEST_ASSERT_EQUAL_INT(MSG_STATE_FREE, messagePool[winlink].state);
+    TEST_ASSERT_EQUAL_INT(MSG_STATE_WAITING_ACK, messagePool[other].state);
+    MSGBUFFER_Utils::processWheel(START_TIME + 30000, collectRetry);
+    TEST_ASSERT_EQUAL_UINT8(1, retriedCount);
+    TEST_ASSERT_EQUAL_INT(other, retried[0]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_hash_packet);
+    RUN_TEST(test_duplicate_within_window);
+    RUN_TEST(test_duplicate_oldest_overwritten);
+    RUN_TEST(test_classify_payload);
+    RUN_TEST(test_payload_tokenizer);
+    RUN_TEST(test_pool_queue_order);
+    RUN_TEST(test_pool_full_and_truncated);
+    RUN_TEST(test_ack_releases_message);
+    RUN_TEST(test_wheel_hands_out_due_retries);
+    RUN_TEST(test_release_messages_of_station);
+    return UNITY_END();
+}
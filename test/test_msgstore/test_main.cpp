@@ -0,0 +1,200 @@
+/* Copyright (C) 2025 Ricardo Guzman - CA2RXU
+ *
+ * This file is part of LoRa APRS Tracker.
+ *
+ * LoRa APRS Tracker is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * LoRa APRS Tracker is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LoRa APRS Tracker. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <unity.h>
+#include <LittleFS.h>
+#include "msgstore_utils.h"
+
+#define STORE_PATH      "/test.bin"
+#define LEGACY_PATH     "/test.txt"
+#define STORE_CAPACITY  4
+
+
+MessageStore    store;
+
+void setUp() {
+    LittleFS.format();
+    store = {STORE_PATH, STORE_CAPACITY, File(), 0, 0, 0};
+}
+
+void tearDown() {
+    store.file.close();
+}
+
+void assertMessage(uint16_t index, const char* expected) {
+    String text;
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::read(store, index, text));
+    TEST_ASSERT_EQUAL_STRING(expected, text.c_str());
+}
+
+void test_append_and_read() {
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    TEST_ASSERT_EQUAL_UINT16(0, MSGSTORE_Utils::count(store));
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::append(store, "CA2RXU-7,first"));
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::append(store, "CD2RXU,second"));
+    TEST_ASSERT_EQUAL_UINT16(2, MSGSTORE_Utils::count(store));
+    assertMessage(0, "CA2RXU-7,first");
+    assertMessage(1, "CD2RXU,second");
+
+    String text;
+    TEST_ASSERT_FALSE(MSGSTORE_Utils::read(store, 2, text));
+}
+
+void test_oldest_overwritten_when_full() {
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    for (int i = 0; i < STORE_CAPACITY + 2; i++) MSGSTORE_Utils::append(store, String("message ") + String(i));
+    TEST_ASSERT_EQUAL_UINT16(STORE_CAPACITY, MSGSTORE_Utils::count(store));
+    assertMessage(0, "message 2");
+    assertMessage(STORE_CAPACITY - 1, "message 5");
+}
+
+void test_long_message_truncated() {
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    String text;
+    for (int i = 0; i < MSGSTORE_TEXT_SIZE + 10; i++) text += 'x';
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::append(store, text));
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::read(store, 0, text));
+    TEST_ASSERT_EQUAL_INT(MSGSTORE_TEXT_SIZE, text.length());
+}
+
+void test_reopen_recovers_sequence() {
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    for (int i = 0; i < STORE_CAPACITY + 1; i++) MSGSTORE_Utils::append(store, String("message ") + String(i));
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    TEST_ASSERT_EQUAL_UINT16(STORE_CAPACITY, MSGSTORE_Utils::count(store));
+    assertMessage(0, "message 1");
+    MSGSTORE_Utils::append(store, "message 5");
+    assertMessage(STORE_CAPACITY - 1, "message 5");
+}
+
+void test_torn_record_skipped() {
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    MSGSTORE_Utils::append(store, "kept");
+    MSGSTORE_Utils::append(store, "torn");
+    store.file.close();
+
+    File file = LittleFS.open(STORE_PATH, "r+");
+    file.seek(8 + 1 * MSGSTORE_RECORD_SIZE + 8);      // text of the record in slot 1
+    file.write((const uint8_t*)"X", 1);
+    file.close();
+
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    TEST_ASSERT_EQUAL_UINT16(1, MSGSTORE_Utils::count(store));
+    assertMessage(0, "kept");
+}
+
+void test_torn_record_in_middle_not_counted() {
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    MSGSTORE_Utils::append(store, "first");
+    MSGSTORE_Utils::append(store, "torn");
+    MSGSTORE_Utils::append(store, "third");
+    store.file.close();
+
+    File file = LittleFS.open(STORE_PATH, "r+");
+    file.seek(8 + 1 * MSGSTORE_RECORD_SIZE + 8);
+    file.write((const uint8_t*)"X", 1);
+    file.close();
+
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    TEST_ASSERT_EQUAL_UINT16(2, MSGSTORE_Utils::count(store));
+    assertMessage(0, "first");
+    assertMessage(1, "third");
+    String page[3];
+    TEST_ASSERT_EQUAL_UINT16(2, MSGSTORE_Utils::readPage(store, 0, page, 3));
+    TEST_ASSERT_EQUAL_STRING("third", page[1].c_str());
+
+    MSGSTORE_Utils::append(store, "fourth");        // the file is full again: "first" goes, nothing else
+    TEST_ASSERT_EQUAL_UINT16(3, MSGSTORE_Utils::count(store));
+    MSGSTORE_Utils::append(store, "fifth");
+    TEST_ASSERT_EQUAL_UINT16(3, MSGSTORE_Utils::count(store));
+    assertMessage(0, "third");
+    assertMessage(2, "fifth");
+}
+
+void test_stale_record_not_counted() {
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    MSGSTORE_Utils::append(store, "stale");
+    store.file.seek(8);
+    uint8_t staleRecord[MSGSTORE_RECORD_SIZE];
+    store.file.read(staleRecord, sizeof(staleRecord));
+    for (int i = 1; i <= STORE_CAPACITY + 1; i++) MSGSTORE_Utils::append(store, String("message ") + String(i));
+    store.file.close();
+
+    File file = LittleFS.open(STORE_PATH, "r+");    // as if the overwrite of slot 0 never reached the flash
+    file.seek(8);
+    file.write(staleRecord, sizeof(staleRecord));
+    file.close();
+
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    TEST_ASSERT_EQUAL_UINT16(STORE_CAPACITY - 1, MSGSTORE_Utils::count(store));
+    assertMessage(0, "message 2");
+    assertMessage(STORE_CAPACITY - 2, "message 5");
+}
+
+void test_bad_header_recreates_store() {
+    File file = LittleFS.open(STORE_PATH, FILE_WRITE);
+    file.write((const uint8_t*)"garbage!", 8);
+    file.close();
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    TEST_ASSERT_EQUAL_UINT16(0, MSGSTORE_Utils::count(store));
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::append(store, "fresh"));
+    assertMessage(0, "fresh");
+}
+
+void test_legacy_migration() {
+    File legacy = LittleFS.open(LEGACY_PATH, FILE_WRITE);
+    const char lines[] = "CA2RXU,one\n\n  CD2RXU,two  \r\n";
+    legacy.write((const uint8_t*)lines, strlen(lines));
+    legacy.close();
+
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store, LEGACY_PATH));
+    TEST_ASSERT_EQUAL_UINT16(2, MSGSTORE_Utils::count(store));
+    assertMessage(0, "CA2RXU,one");
+    assertMessage(1, "CD2RXU,two");
+    TEST_ASSERT_FALSE(LittleFS.exists(LEGACY_PATH));
+}
+
+void test_read_page_and_clear() {
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::open(store));
+    for (int i = 0; i < 3; i++) MSGSTORE_Utils::append(store, String("message ") + String(i));
+    String page[2];
+    TEST_ASSERT_EQUAL_UINT16(2, MSGSTORE_Utils::readPage(store, 1, page, 2));
+    TEST_ASSERT_EQUAL_STRING("message 1", page[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("message 2", page[1].c_str());
+    TEST_ASSERT_EQUAL_UINT16(0, MSGSTORE_Utils::readPage(store, 3, page, 2));
+
+    MSGSTORE_Utils::clear(store);
+    TEST_ASSERT_EQUAL_UINT16(0, MSGSTORE_Utils::count(store));
+    TEST_ASSERT_TRUE(MSGSTORE_Utils::append(store, "after clear"));
+    assertMessage(0, "after clear");
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_append_and_read);
+    RUN_TEST(test_oldest_overwritten_when_full);
+    RUN_TEST(test_long_message_truncated);
+    RUN_TEST(test_reopen_recovers_sequence);
+    RUN_TEST(test_torn_record_skipped);
+    RUN_TEST(test_torn_record_in_middle_not_counted);
+    RUN_TEST(test_stale_record_not_counted);
+    RUN_TEST(test_bad_header_recreates_store);
+    RUN_TEST(test_legacy_migration);
+    RUN_TEST(test_read_page_and_clear);
+    return UNITY_END();
+}